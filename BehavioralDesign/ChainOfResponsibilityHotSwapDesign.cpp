@@ -0,0 +1,351 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+using namespace std;
+
+/*
+    Why hot-swappable chains?
+    In ChainOfResponsibilityDesign.cpp a chain is changed by calling
+    setNextApprover on live nodes. A request walking the chain at the
+    same time can see it half rewired, and holding every hop through a
+    shared_ptr means refcount traffic on shared cache lines.
+
+    Here a chain is an immutable ApprovalChain: it owns its approvers,
+    links them with plain pointers once at construction and never
+    changes again. A ChainRegistry publishes the current chain through
+    one atomic pointer:
+    - a reconfiguration builds a whole new chain, swaps the pointer
+      and retires the old chain; it never waits for requests
+    - a request pins the epoch in its reader's own slot, loads the
+      pointer and walks the chain, with no refcounting and no lock
+    - retired chains are freed once every pinned epoch is newer than
+      the epoch they were retired at (same scheme as
+      IteratorMvccPlaylistDesign.cpp, but each reader thread owns a
+      slot, so pinning is a store and a fence instead of a CAS)
+*/
+
+// --------- Immutable chain ---------
+class Approver {
+protected:
+    const Approver* nextApprover = nullptr;     // set once by ApprovalChain
+    int limit;
+    friend class ApprovalChain;
+public:
+    Approver(int limit) : limit(limit) {}
+    // what the chain says about the request, nullptr if it says nothing
+    virtual const char* processLeaveRequest(int leaveDays) const = 0;
+    virtual ~Approver() = default;
+};
+
+class Supervisor : public Approver {
+public:
+    Supervisor(int limit = 3) : Approver(limit) {}
+    const char* processLeaveRequest(int leaveDays) const override {
+        if (leaveDays <= limit) {
+            return "Supervisor approved the leave\n";
+        }
+        else if (nextApprover) {
+            return nextApprover -> processLeaveRequest(leaveDays);
+        }
+        return nullptr;
+    }
+};
+
+class Manager : public Approver {
+public:
+    Manager(int limit = 7) : Approver(limit) {}
+    const char* processLeaveRequest(int leaveDays) const override {
+        if (leaveDays <= limit) {
+            return "Manager approved the leave\n";
+        }
+        else if (nextApprover) {
+            return nextApprover -> processLeaveRequest(leaveDays);
+        }
+        return nullptr;
+    }
+};
+
+class Director : public Approver {
+public:
+    Director(int limit = 14) : Approver(limit) {}
+    const char* processLeaveRequest(int leaveDays) const override {
+        if (leaveDays <= limit) {
+            return "Director approved the leave\n";
+        }
+        else if (nextApprover != nullptr) {
+            return nextApprover -> processLeaveRequest(leaveDays);
+        }
+        return "Leave request denied\n";
+    }
+};
+
+class ApprovalChain {
+private:
+    vector<unique_ptr<Approver>> approvers;
+    uint64_t version;
+public:
+    ApprovalChain(vector<unique_ptr<Approver>> chain, uint64_t version = 0)
+        : approvers(std::move(chain)), version(version) {
+        if (approvers.empty()) throw invalid_argument("empty approval chain");
+        for (size_t i = 0; i + 1 < approvers.size(); i++) approvers[i] -> nextApprover = approvers[i + 1].get();
+    }
+
+    ApprovalChain(const ApprovalChain&) = delete;
+    ApprovalChain& operator=(const ApprovalChain&) = delete;
+
+    const char* processLeaveRequest(int leaveDays) const {
+        return approvers.front() -> processLeaveRequest(leaveDays);
+    }
+
+    uint64_t getVersion() const { return version; }
+};
+
+// --------- Epochs ---------
+class EpochDomain {
+private:
+    static constexpr uint64_t IDLE = UINT64_MAX;
+    static constexpr size_t SLOTS = 256;
+
+    struct alignas(64) Slot {
+        atomic<bool> claimed{false};
+        atomic<uint64_t> epoch{IDLE};
+    };
+
+    atomic<uint64_t> global{1};
+    Slot slots[SLOTS];
+public:
+    // one per reader thread, owns a slot for its lifetime
+    class Reader {
+    private:
+        EpochDomain* domain = nullptr;
+        Slot* slot = nullptr;
+    public:
+        Reader(EpochDomain* domain, Slot* slot) : domain(domain), slot(slot) {}
+        Reader(Reader&& other) noexcept : domain(other.domain), slot(other.slot) { other.slot = nullptr; }
+        Reader& operator=(Reader&&) = delete;
+        ~Reader() {
+            if (slot) slot -> claimed.store(false, memory_order_release);
+        }
+
+        // everything loaded between enter() and exit() stays alive
+        void enter() {
+            slot -> epoch.store(domain -> global.load(memory_order_relaxed), memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);      // announced before any shared pointer is loaded
+        }
+        void exit() {
+            slot -> epoch.store(IDLE, memory_order_release);
+        }
+    };
+
+    Reader registerReader() {
+        for (auto& s : slots) {
+            bool free = false;
+            if (!s.claimed.load(memory_order_relaxed) && s.claimed.compare_exchange_strong(free, true)) {
+                return Reader(this, &s);
+            }
+        }
+        throw runtime_error("too many reader threads");
+    }
+
+    // writers: the epoch that retired objects are tagged with
+    uint64_t advance() { return global.fetch_add(1); }
+
+    // objects retired at an epoch below this are unreachable
+    uint64_t oldestPinned() const {
+        uint64_t oldest = global.load();
+        for (auto& s : slots) oldest = min(oldest, s.epoch.load());
+        return oldest;
+    }
+};
+
+// --------- Registry ---------
+class ChainRegistry {
+private:
+    struct Retired {
+        uint64_t epoch;
+        const ApprovalChain* chain;
+    };
+
+    atomic<const ApprovalChain*> current;
+    EpochDomain epochs;
+    mutex writer;                       // reconfigurations serialize, requests never touch it
+    vector<Retired> retired;
+    size_t published = 0, freed = 0;
+
+    void reclaim() {
+        uint64_t oldest = epochs.oldestPinned();
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); i++) {
+            if (retired[i].epoch < oldest) {
+                delete retired[i].chain;
+                freed++;
+            }
+            else retired[kept++] = retired[i];
+        }
+        retired.resize(kept);
+    }
+public:
+    class Reader {
+    private:
+        const ChainRegistry* registry;
+        EpochDomain::Reader epoch;
+    public:
+        Reader(ChainRegistry* registry) : registry(registry), epoch(registry -> epochs.registerReader()) {}
+
+        const char* processLeaveRequest(int leaveDays) {
+            epoch.enter();
+            const char* decision = registry -> current.load(memory_order_acquire) -> processLeaveRequest(leaveDays);
+            epoch.exit();
+            return decision;
+        }
+    };
+
+    ChainRegistry(unique_ptr<ApprovalChain> initial) : current(initial.release()) {}
+
+    ~ChainRegistry() {
+        for (auto& r : retired) delete r.chain;
+        delete current.load();
+    }
+
+    // never waits for requests in flight, they finish on the chain they loaded
+    void publish(unique_ptr<ApprovalChain> next) {
+        lock_guard<mutex> lock(writer);
+        const ApprovalChain* old = current.exchange(next.release());
+        retired.push_back({epochs.advance(), old});
+        published++;
+        reclaim();
+    }
+
+    // one per request thread
+    Reader reader() { return Reader(this); }
+
+    size_t publishedCount() { lock_guard<mutex> lock(writer); return published; }
+    size_t freedCount() { lock_guard<mutex> lock(writer); return freed; }
+    size_t retiredBacklog() { lock_guard<mutex> lock(writer); return retired.size(); }
+};
+
+// --------- Benchmark ---------
+// the same chain published as shared_ptr, every request copies it (two refcount updates)
+class RefcountedRegistry {
+private:
+    atomic<shared_ptr<const ApprovalChain>> current;
+public:
+    RefcountedRegistry(unique_ptr<ApprovalChain> initial) : current(shared_ptr<const ApprovalChain>(std::move(initial))) {}
+
+    void publish(unique_ptr<ApprovalChain> next) {
+        current.store(shared_ptr<const ApprovalChain>(std::move(next)));
+    }
+
+    const char* processLeaveRequest(int leaveDays) const {
+        return current.load() -> processLeaveRequest(leaveDays);
+    }
+};
+
+// two configurations the benchmark flips between
+unique_ptr<ApprovalChain> standardChain(uint64_t version) {
+    vector<unique_ptr<Approver>> chain;
+    chain.push_back(make_unique<Supervisor>());
+    chain.push_back(make_unique<Manager>());
+    chain.push_back(make_unique<Director>());
+    return make_unique<ApprovalChain>(std::move(chain), version);
+}
+
+unique_ptr<ApprovalChain> holidayChain(uint64_t version) {
+    vector<unique_ptr<Approver>> chain;
+    chain.push_back(make_unique<Supervisor>(5));
+    chain.push_back(make_unique<Director>(21));
+    return make_unique<ApprovalChain>(std::move(chain), version);
+}
+
+unique_ptr<ApprovalChain> configuration(uint64_t version) {
+    return version % 2 ? holidayChain(version) : standardChain(version);
+}
+
+struct Throughput {
+    double requestsPerSec;
+    size_t invalid;
+    size_t reconfigurations;
+};
+
+// readers run for the duration while one writer republishes every 50 us
+template <typename Registry, typename Process>
+Throughput measure(Registry& registry, int readers, chrono::milliseconds duration, Process process) {
+    auto standard = standardChain(0), holiday = holidayChain(1);
+    atomic<bool> stop{false};
+    atomic<size_t> requests{0}, invalid{0};
+    size_t reconfigurations = 0;
+
+    vector<thread> threads;
+    for (int t = 0; t < readers; t++) {
+        threads.emplace_back([&, t] {
+            mt19937 rng(t);
+            size_t done = 0, bad = 0;
+            auto read = process(registry);
+            while (!stop.load(memory_order_relaxed)) {
+                for (int i = 0; i < 1024; i++) {
+                    int days = rng() % 25;
+                    const char* decision = read(days);
+                    // every decision must come from one whole configuration, never a mix
+                    bad += decision != standard -> processLeaveRequest(days) && decision != holiday -> processLeaveRequest(days);
+                }
+                done += 1024;
+            }
+            requests += done;
+            invalid += bad;
+        });
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    while (chrono::steady_clock::now() - t0 < duration) {
+        registry.publish(configuration(++reconfigurations));
+        this_thread::sleep_for(chrono::microseconds(50));
+    }
+    stop = true;
+    for (auto& t : threads) t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return {requests / seconds, invalid.load(), reconfigurations};
+}
+
+int main() {
+    ChainRegistry registry(standardChain(0));
+    auto reader = registry.reader();
+
+    int leaveDays = 16;
+    cout << "Employee requests " << leaveDays << " days of leave.\n";
+    cout << reader.processLeaveRequest(leaveDays);
+
+    registry.publish(holidayChain(1));
+    cout << "After switching to the holiday chain:\n";
+    cout << reader.processLeaveRequest(leaveDays);
+
+    cout << "\n--- requests during continuous reconfiguration, "
+         << thread::hardware_concurrency() << " hardware threads ---" << endl;
+    const auto duration = chrono::milliseconds(400);
+    for (int readers : {1, 2, 4, 8}) {
+        ChainRegistry rcu(standardChain(0));
+        Throughput a = measure(rcu, readers, duration, [](ChainRegistry& r) {
+            return [reader = make_shared<ChainRegistry::Reader>(r.reader())](int days) {
+                return reader -> processLeaveRequest(days);
+            };
+        });
+        cout << readers << " readers, epoch-pinned pointer:   " << (uint64_t)(a.requestsPerSec / 1e3) << "k req/s, "
+             << a.reconfigurations << " reconfigurations, " << a.invalid << " invalid, "
+             << rcu.freedCount() << " chains freed, " << rcu.retiredBacklog() << " waiting" << endl;
+
+        RefcountedRegistry refcounted(standardChain(0));
+        Throughput b = measure(refcounted, readers, duration, [](RefcountedRegistry& r) {
+            return [&r](int days) { return r.processLeaveRequest(days); };
+        });
+        cout << readers << " readers, atomic<shared_ptr> copy: " << (uint64_t)(b.requestsPerSec / 1e3) << "k req/s, "
+             << b.reconfigurations << " reconfigurations, " << b.invalid << " invalid" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,465 @@
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include <list>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+using namespace std;
+
+/*
+    Why a pipelined approval chain?
+    In ChainOfResponsibilityDesign.cpp processLeaveRequest runs the
+    whole chain synchronously on the caller's thread. Real approvers
+    do I/O-bound policy checks with very different latencies, so one
+    request at a time costs the sum of every check it passes through,
+    and nothing overlaps.
+
+    Here every approver is a stage (staged event-driven design):
+    - each stage owns a bounded lock-free MPMC queue and its own
+      worker threads; a worker either decides the request or pushes it
+      to the next stage's queue
+    - full queues push back on the stage before them, so a slow stage
+      throttles intake instead of growing memory
+    - each stage keeps throughput, queue wait, service time and a
+      latency histogram
+    - an autoscaler watches queue depth and worker utilisation and
+      adds workers to a backed-up stage (or retires idle ones), so the
+      slowest stage stops capping end-to-end throughput
+*/
+
+using Clock = chrono::steady_clock;
+
+uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// --------- Approvers ---------
+class Approver {
+protected:
+    shared_ptr<Approver> nextApprover;
+public:
+    void setNextApprover(shared_ptr<Approver> next) {
+        nextApprover = next;
+    }
+    shared_ptr<Approver> getNextApprover() const {
+        return nextApprover;
+    }
+
+    virtual const char* name() const = 0;
+    virtual int limit() const = 0;                      // approves leaveDays <= limit
+    virtual const char* approvedMessage() const = 0;
+    // for requests that reach the end of the chain here, nullptr = dropped
+    virtual const char* unhandledMessage() const { return nullptr; }
+    virtual chrono::microseconds checkLatency() const = 0;
+
+    // the policy check, I/O-bound in real life
+    void check() const {
+        this_thread::sleep_for(checkLatency());
+    }
+
+    // synchronous walk, as in ChainOfResponsibilityDesign.cpp
+    const char* decide(int leaveDays) const {
+        check();
+        if (leaveDays <= limit()) return approvedMessage();
+        if (nextApprover) return nextApprover -> decide(leaveDays);
+        return unhandledMessage();
+    }
+
+    virtual ~Approver() = default;
+};
+
+class Supervisor : public Approver {
+public:
+    const char* name() const override { return "Supervisor"; }
+    int limit() const override { return 3; }
+    const char* approvedMessage() const override { return "Supervisor approved the leave\n"; }
+    chrono::microseconds checkLatency() const override { return chrono::microseconds(10); }
+};
+
+class Manager : public Approver {
+public:
+    const char* name() const override { return "Manager"; }
+    int limit() const override { return 7; }
+    const char* approvedMessage() const override { return "Manager approved the leave\n"; }
+    chrono::microseconds checkLatency() const override { return chrono::microseconds(100); }
+};
+
+class Director : public Approver {
+public:
+    const char* name() const override { return "Director"; }
+    int limit() const override { return 14; }
+    const char* approvedMessage() const override { return "Director approved the leave\n"; }
+    const char* unhandledMessage() const override { return "Leave request denied\n"; }
+    chrono::microseconds checkLatency() const override { return chrono::microseconds(500); }
+};
+
+// --------- Bounded MPMC queue ---------
+// Vyukov's array queue: every cell carries a sequence number that says
+// whether it is ready for the producer or the consumer of a given lap
+template <typename T>
+class BoundedQueue {
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        T value;
+    };
+
+    vector<Cell> cells;
+    size_t mask;
+    alignas(64) atomic<size_t> enqueuePos{0};
+    alignas(64) atomic<size_t> dequeuePos{0};
+public:
+    BoundedQueue(size_t capacity) : cells(capacity), mask(capacity - 1) {
+        if (capacity < 2 || (capacity & mask)) throw invalid_argument("capacity must be a power of two");
+        for (size_t i = 0; i < capacity; i++) cells[i].sequence.store(i, memory_order_relaxed);
+    }
+
+    bool tryPush(const T& value) {
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) return false;                        // full
+            else pos = enqueuePos.load(memory_order_relaxed);
+        }
+    }
+
+    bool tryPop(T& out) {
+        size_t pos = dequeuePos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    out = cell.value;
+                    cell.sequence.store(pos + mask + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) return false;                        // empty
+            else pos = dequeuePos.load(memory_order_relaxed);
+        }
+    }
+
+    // approximate, for metrics and the autoscaler
+    size_t depth() const {
+        size_t in = enqueuePos.load(memory_order_relaxed), out = dequeuePos.load(memory_order_relaxed);
+        return in > out ? in - out : 0;
+    }
+};
+
+// --------- Metrics ---------
+// log2 buckets of microseconds, cheap enough to bump on every request
+class LatencyHistogram {
+private:
+    static constexpr int BUCKETS = 40;
+    atomic<uint64_t> buckets[BUCKETS] = {};
+public:
+    void record(uint64_t ns) {
+        uint64_t us = ns / 1000;
+        int b = 0;
+        while (us) {
+            us >>= 1;
+            b++;
+        }
+        buckets[min(b, BUCKETS - 1)].fetch_add(1, memory_order_relaxed);
+    }
+
+    // upper bound of the bucket holding the q-th quantile, in microseconds
+    uint64_t quantileUs(double q) const {
+        uint64_t total = 0;
+        for (auto& b : buckets) total += b.load(memory_order_relaxed);
+        uint64_t rank = q * total, seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += buckets[b].load(memory_order_relaxed);
+            if (seen > rank) return 1ULL << b;
+        }
+        return 0;
+    }
+};
+
+struct StageMetrics {
+    atomic<uint64_t> processed{0};
+    atomic<uint64_t> waitNs{0};             // time in the queue
+    atomic<uint64_t> serviceNs{0};          // time in check() and hand-off
+    LatencyHistogram latency;               // wait + service
+};
+
+// --------- Pipeline ---------
+struct LeaveRequest {
+    int leaveDays = 0;
+    uint64_t submittedNs = 0;
+    uint64_t enqueuedNs = 0;                // entered the current stage's queue
+    const char* decision = nullptr;
+};
+
+struct PipelineConfig {
+    size_t queueCapacity = 1024;
+    int minWorkers = 1;
+    int maxWorkers = 1;                     // == minWorkers turns autoscaling off
+    chrono::milliseconds scaleInterval{10};
+};
+
+class ApprovalPipeline {
+private:
+    struct Worker {
+        thread t;
+        atomic<bool> retire{false};
+        atomic<bool> exited{false};         // work() returned, join() will not block
+    };
+
+    struct Stage {
+        const Approver* approver;
+        Stage* next = nullptr;
+        BoundedQueue<LeaveRequest*> queue;
+        StageMetrics metrics;
+        list<Worker> workers;               // touched by the constructor, the autoscaler and shutdown only;
+                                            // a list so erasing a retired worker keeps the others' addresses
+        atomic<int> active{0};
+        int peak = 0;
+        uint64_t lastServiceNs = 0;         // autoscaler bookkeeping
+
+        Stage(const Approver* approver, size_t capacity) : approver(approver), queue(capacity) {}
+    };
+
+    PipelineConfig config;
+    shared_ptr<Approver> chain;             // keeps the approvers alive
+    vector<unique_ptr<Stage>> stages;
+    atomic<bool> stopping{false};
+    atomic<uint64_t> submitted{0}, completed{0};
+    LatencyHistogram endToEnd;
+    thread autoscaler;
+
+    static void backoff(int& spins) {
+        if (++spins < 64) this_thread::yield();
+        else this_thread::sleep_for(chrono::microseconds(50));
+    }
+
+    void push(Stage& stage, LeaveRequest* r) {
+        r -> enqueuedNs = nowNs();
+        for (int spins = 0; !stage.queue.tryPush(r); ) backoff(spins);     // backpressure
+    }
+
+    void finish(LeaveRequest* r, const char* decision) {
+        r -> decision = decision;
+        endToEnd.record(nowNs() - r -> submittedNs);
+        completed.fetch_add(1, memory_order_release);
+    }
+
+    void work(Stage& stage, Worker& self) {
+        int spins = 0;
+        while (!self.retire.load(memory_order_relaxed)) {
+            LeaveRequest* r;
+            if (!stage.queue.tryPop(r)) {
+                if (stopping.load(memory_order_acquire)) break;
+                backoff(spins);
+                continue;
+            }
+            spins = 0;
+            uint64_t enqueued = r -> enqueuedNs, started = nowNs();
+            const Approver* a = stage.approver;
+            a -> check();
+            // r belongs to the next stage or the submitter after this
+            if (r -> leaveDays <= a -> limit()) finish(r, a -> approvedMessage());
+            else if (stage.next) push(*stage.next, r);
+            else finish(r, a -> unhandledMessage());
+
+            uint64_t done = nowNs();
+            stage.metrics.processed.fetch_add(1, memory_order_relaxed);
+            stage.metrics.waitNs.fetch_add(started - enqueued, memory_order_relaxed);
+            stage.metrics.serviceNs.fetch_add(done - started, memory_order_relaxed);
+            stage.metrics.latency.record(done - enqueued);
+        }
+        self.exited.store(true, memory_order_release);
+    }
+
+    void addWorker(Stage& stage) {
+        Worker& w = stage.workers.emplace_back();
+        w.t = thread([this, &stage, &w] { work(stage, w); });
+        stage.peak = max(stage.peak, stage.active.fetch_add(1) + 1);
+    }
+
+    void retireWorker(Stage& stage) {
+        for (auto it = stage.workers.rbegin(); it != stage.workers.rend(); ++it) {
+            if (!it -> retire.load()) {
+                it -> retire.store(true);
+                stage.active.fetch_sub(1);
+                return;
+            }
+        }
+    }
+
+    // joins retired workers that have finished their last request
+    void reapRetired(Stage& stage) {
+        for (auto it = stage.workers.begin(); it != stage.workers.end(); ) {
+            if (it -> exited.load(memory_order_acquire)) {
+                it -> t.join();
+                it = stage.workers.erase(it);
+            }
+            else ++it;
+        }
+    }
+
+    // backed-up stages grow by half again, idle ones shrink by one
+    void autoscale() {
+        double intervalNs = chrono::duration_cast<chrono::nanoseconds>(config.scaleInterval).count();
+        while (!stopping.load(memory_order_acquire)) {
+            this_thread::sleep_for(config.scaleInterval);
+            for (auto& s : stages) {
+                reapRetired(*s);
+                int workers = s -> active.load();
+                uint64_t service = s -> metrics.serviceNs.load(memory_order_relaxed);
+                double utilisation = (service - s -> lastServiceNs) / (intervalNs * workers);
+                s -> lastServiceNs = service;
+                size_t depth = s -> queue.depth();
+
+                if (depth > (size_t)workers && workers < config.maxWorkers) {
+                    int grow = min(max(1, workers / 2), config.maxWorkers - workers);
+                    for (int i = 0; i < grow; i++) addWorker(*s);
+                }
+                else if (depth == 0 && utilisation < 0.3 && workers > config.minWorkers) {
+                    retireWorker(*s);
+                }
+            }
+        }
+    }
+public:
+    ApprovalPipeline(shared_ptr<Approver> head, PipelineConfig config) : config(config), chain(head) {
+        if (!head) throw invalid_argument("empty approval chain");
+        if (config.minWorkers < 1 || config.maxWorkers < config.minWorkers) throw invalid_argument("bad worker limits");
+        for (const Approver* a = head.get(); a; a = a -> getNextApprover().get()) {
+            stages.push_back(make_unique<Stage>(a, config.queueCapacity));
+            if (stages.size() > 1) stages[stages.size() - 2] -> next = stages.back().get();
+        }
+        for (auto& s : stages) {
+            for (int i = 0; i < config.minWorkers; i++) addWorker(*s);
+        }
+        if (config.maxWorkers > config.minWorkers) autoscaler = thread([this] { autoscale(); });
+    }
+
+    ~ApprovalPipeline() {
+        shutdown();
+    }
+
+    // blocks while the first stage is full; the request must outlive its decision
+    void submit(LeaveRequest* r) {
+        r -> submittedNs = nowNs();
+        r -> decision = nullptr;
+        submitted.fetch_add(1, memory_order_relaxed);
+        push(*stages.front(), r);
+    }
+
+    // waits for every submitted request to be decided
+    void drain() {
+        while (completed.load(memory_order_acquire) < submitted.load(memory_order_relaxed)) {
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+    }
+
+    // decides everything already submitted, then stops the workers
+    void shutdown() {
+        if (stopping.load()) return;
+        drain();
+        stopping.store(true, memory_order_release);
+        if (autoscaler.joinable()) autoscaler.join();
+        for (auto& s : stages) {
+            for (auto& w : s -> workers) w.t.join();
+        }
+    }
+
+    void report(double seconds) const {
+        cout << "  " << left << setw(12) << "stage" << right << setw(8) << "workers" << setw(8) << "peak"
+             << setw(10) << "req/s" << setw(12) << "wait us" << setw(12) << "service us" << setw(10) << "p99 us" << endl;
+        for (auto& s : stages) {
+            const StageMetrics& m = s -> metrics;
+            uint64_t n = max<uint64_t>(1, m.processed.load());
+            cout << "  " << left << setw(12) << s -> approver -> name() << right << setw(8) << s -> active.load()
+                 << setw(8) << s -> peak << setw(10) << (uint64_t)(m.processed.load() / seconds)
+                 << setw(12) << m.waitNs.load() / n / 1000 << setw(12) << m.serviceNs.load() / n / 1000
+                 << setw(10) << m.latency.quantileUs(0.99) << endl;
+        }
+        cout << "  end to end: p50 <= " << endToEnd.quantileUs(0.5) << " us, p99 <= " << endToEnd.quantileUs(0.99) << " us" << endl;
+    }
+};
+
+// --------- Benchmark ---------
+double secondsSince(Clock::time_point t0) {
+    return chrono::duration<double>(Clock::now() - t0).count();
+}
+
+size_t countMismatches(const shared_ptr<Approver>& chain, const vector<LeaveRequest>& requests) {
+    size_t mismatches = 0;
+    for (auto& r : requests) {
+        const Approver* a = chain.get();
+        while (r.leaveDays > a -> limit() && a -> getNextApprover()) a = a -> getNextApprover().get();
+        mismatches += r.decision != (r.leaveDays <= a -> limit() ? a -> approvedMessage() : a -> unhandledMessage());
+    }
+    return mismatches;
+}
+
+void runPipeline(const string& label, shared_ptr<Approver> chain, PipelineConfig config, const vector<int>& days) {
+    vector<LeaveRequest> requests(days.size());
+    for (size_t i = 0; i < days.size(); i++) requests[i].leaveDays = days[i];
+
+    auto t0 = Clock::now();
+    ApprovalPipeline pipeline(chain, config);
+    for (auto& r : requests) pipeline.submit(&r);
+    pipeline.drain();
+    double seconds = secondsSince(t0);
+    pipeline.shutdown();
+
+    cout << label << ": " << (uint64_t)(days.size() / seconds) << " requests/s, "
+         << countMismatches(chain, requests) << " mismatches" << endl;
+    pipeline.report(seconds);
+}
+
+int main() {
+    auto supervisor = make_shared<Supervisor>();
+    auto manager = make_shared<Manager>();
+    auto director = make_shared<Director>();
+
+    supervisor -> setNextApprover(manager);
+    manager -> setNextApprover(director);
+
+    {
+        ApprovalPipeline pipeline(supervisor, PipelineConfig{});
+        vector<LeaveRequest> requests(4);
+        int leaveDays[] = {2, 5, 10, 16};
+        for (int i = 0; i < 4; i++) {
+            requests[i].leaveDays = leaveDays[i];
+            pipeline.submit(&requests[i]);
+        }
+        pipeline.drain();
+        for (auto& r : requests) cout << "Employee requests " << r.leaveDays << " days of leave: " << r.decision;
+    }
+
+    vector<int> days(20'000);
+    mt19937 rng(7);
+    for (auto& d : days) d = rng() % 21;
+
+    cout << "\n--- synchronous chain, " << days.size() / 4 << " requests ---" << endl;
+    auto t0 = Clock::now();
+    size_t denied = 0;
+    for (size_t i = 0; i < days.size() / 4; i++) denied += supervisor -> decide(days[i]) == director -> unhandledMessage();
+    cout << "one thread: " << (uint64_t)(days.size() / 4 / secondsSince(t0)) << " requests/s (" << denied << " denied)" << endl;
+
+    cout << "\n--- pipeline, " << days.size() << " requests ---" << endl;
+    runPipeline("one worker per stage", supervisor, PipelineConfig{1024, 1, 1}, days);
+    runPipeline("autoscaled, 1..64 workers", supervisor, PipelineConfig{1024, 1, 64}, days);
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+using namespace std;
+
+/*
+    Why a compiled approval table?
+    The chain in ChainOfResponsibilityDesign.cpp resolves every request
+    by hopping Supervisor -> Manager -> Director through shared_ptr and
+    a virtual call per hop. When HR processes requests in bulk, those
+    pointer hops and unpredictable branches are most of the cost.
+
+    Each approver here has a day limit (approves leaveDays <= limit)
+    and passes the request on otherwise, and the last approver decides
+    what happens to requests nobody approved (Director denies, the
+    others drop them silently, same as the original). So any chain is
+    a step function of leaveDays, and ApprovalTable::compile turns it
+    into a sorted array of limits plus the decision for each step:
+    - approvers whose limit is not above an earlier one never see a
+      request and are left out
+    - resolve() is a branchless binary search over the limits
+    - processBatch() counts, for 4 requests at a time, how many limits
+      each one exceeds with SSE2 compares (the table is tiny, so this
+      beats searching), falling back to resolve() for long tables
+    Decisions are the same message pointers the dynamic chain returns,
+    so both can be compared exactly, "denied" and dropped included.
+*/
+
+// --------- Dynamic chain ---------
+class Approver {
+protected:
+    shared_ptr<Approver> nextApprover;
+public:
+    void setNextApprover(shared_ptr<Approver> next) {
+        nextApprover = next;
+    }
+    shared_ptr<Approver> getNextApprover() const {
+        return nextApprover;
+    }
+
+    virtual int limit() const = 0;                      // approves leaveDays <= limit
+    virtual const char* approvedMessage() const = 0;
+    // for requests that reach the end of the chain here, nullptr = dropped
+    virtual const char* unhandledMessage() const { return nullptr; }
+
+    // what the chain says about the request, nullptr if it says nothing
+    const char* decide(int leaveDays) const {
+        if (leaveDays <= limit()) return approvedMessage();
+        if (nextApprover) return nextApprover -> decide(leaveDays);
+        return unhandledMessage();
+    }
+
+    void processLeaveRequest(int leaveDays) const {
+        if (const char* message = decide(leaveDays)) cout << message;
+    }
+
+    virtual ~Approver() = default;
+};
+
+class Supervisor : public Approver {
+public:
+    int limit() const override { return 3; }
+    const char* approvedMessage() const override { return "Supervisor approved the leave\n"; }
+};
+
+class Manager : public Approver {
+public:
+    int limit() const override { return 7; }
+    const char* approvedMessage() const override { return "Manager approved the leave\n"; }
+};
+
+class Director : public Approver {
+public:
+    int limit() const override { return 14; }
+    const char* approvedMessage() const override { return "Director approved the leave\n"; }
+    const char* unhandledMessage() const override { return "Leave request denied\n"; }
+};
+
+// --------- Compiled table ---------
+class ApprovalTable {
+private:
+    static constexpr size_t SIMD_LIMITS = 16;   // longer tables use the binary search in batches too
+
+    vector<int> limits;                 // strictly increasing, padded with INT_MAX to a power of two
+    size_t count = 0;                   // real limits
+    vector<const char*> decisions;      // decisions[i] for limits[i - 1] < leaveDays <= limits[i], last = unhandled
+public:
+    static ApprovalTable compile(const shared_ptr<Approver>& head) {
+        if (!head) throw invalid_argument("empty approval chain");
+        ApprovalTable table;
+        const Approver* last = nullptr;
+        for (const Approver* a = head.get(); a; a = a -> getNextApprover().get()) {
+            if (table.count == 0 || a -> limit() > table.limits.back()) {
+                table.limits.push_back(a -> limit());
+                table.decisions.push_back(a -> approvedMessage());
+                table.count++;
+            }
+            last = a;
+            if (table.count > 255) throw length_error("approval chain too long");
+        }
+        table.decisions.push_back(last -> unhandledMessage());
+
+        size_t padded = 1;
+        while (padded < table.count) padded <<= 1;
+        table.limits.resize(padded, INT_MAX);
+        return table;
+    }
+
+    // index of the decision: the number of limits below leaveDays
+    uint8_t resolveIndex(int leaveDays) const {
+        const int* base = limits.data();
+        for (size_t n = limits.size(); n > 1; n -= n / 2) {
+            base = base[n / 2 - 1] < leaveDays ? base + n / 2 : base;    // compiles to cmov
+        }
+        return (base - limits.data()) + (*base < leaveDays);     // the INT_MAX padding is never below
+    }
+
+    const char* resolve(int leaveDays) const {
+        return decisions[resolveIndex(leaveDays)];
+    }
+
+    const char* decision(uint8_t idx) const {
+        return decisions[idx];
+    }
+
+    // out[i] = index of the decision for days[i], look it up with decision()
+    void processBatch(span<const int> days, span<uint8_t> out) const {
+        if (out.size() < days.size()) throw invalid_argument("output shorter than the batch");
+        size_t i = 0;
+#if defined(__SSE2__)
+        if (count <= SIMD_LIMITS) {
+            for (; i + 4 <= days.size(); i += 4) {
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(days.data() + i));
+                __m128i exceeded = _mm_setzero_si128();
+                for (size_t k = 0; k < count; k++) {
+                    // compare lanes are -1 where days > limit, so subtracting counts them
+                    exceeded = _mm_sub_epi32(exceeded, _mm_cmpgt_epi32(d, _mm_set1_epi32(limits[k])));
+                }
+                alignas(16) int32_t lanes[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes), exceeded);
+                for (int l = 0; l < 4; l++) out[i + l] = lanes[l];
+            }
+        }
+#endif
+        for (; i < days.size(); i++) out[i] = resolveIndex(days[i]);
+    }
+
+    size_t size() const { return count; }
+};
+
+// --------- Benchmark ---------
+double millisSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+shared_ptr<Approver> makeApprover(char kind) {
+    switch (kind) {
+        case 'S': return make_shared<Supervisor>();
+        case 'M': return make_shared<Manager>();
+        case 'D': return make_shared<Director>();
+    }
+    throw invalid_argument("unknown approver");
+}
+
+// "SMD" -> Supervisor -> Manager -> Director
+shared_ptr<Approver> makeChain(const string& kinds) {
+    shared_ptr<Approver> head, tail;
+    for (char kind : kinds) {
+        auto a = makeApprover(kind);
+        if (tail) tail -> setNextApprover(a);
+        else head = a;
+        tail = a;
+    }
+    return head;
+}
+
+int main() {
+    auto supervisor = make_shared<Supervisor>();
+    auto manager = make_shared<Manager>();
+    auto director = make_shared<Director>();
+
+    supervisor -> setNextApprover(manager);
+    manager -> setNextApprover(director);
+
+    int leaveDays = 16;
+    cout << "Employee requests " << leaveDays << " days of leave.\n";
+    supervisor -> processLeaveRequest(leaveDays);
+
+    ApprovalTable table = ApprovalTable::compile(supervisor);
+    cout << "Compiled table says: " << table.resolve(leaveDays);
+
+    // every chain shape over a range of days, including shadowed approvers and chains that drop
+    size_t checked = 0, mismatches = 0;
+    for (string kinds : {"SMD", "S", "M", "D", "SM", "MS", "DMS", "MSD", "SDM", "DD", "SMDS", "MMSD"}) {
+        auto chain = makeChain(kinds);
+        ApprovalTable compiled = ApprovalTable::compile(chain);
+        vector<int> days;
+        for (int d = -5; d <= 40; d++) days.push_back(d);
+        for (int d : {INT_MIN, INT_MIN + 1, INT_MAX - 1, INT_MAX}) days.push_back(d);
+        vector<uint8_t> out(days.size());
+        compiled.processBatch(days, out);
+        for (size_t i = 0; i < days.size(); i++) {
+            const char* expected = chain -> decide(days[i]);
+            mismatches += compiled.resolve(days[i]) != expected;
+            mismatches += compiled.decision(out[i]) != expected;
+            checked += 2;
+        }
+    }
+    cout << "\nchecked " << checked << " decisions against the dynamic chain, " << mismatches << " mismatches" << endl;
+
+    const size_t n = 20'000'000;
+    cout << "\n--- " << n << " requests ---" << endl;
+    vector<int> days(n);
+    mt19937 rng(7);
+    for (auto& d : days) d = rng() % 21;        // 0..20 days, every branch taken unpredictably
+    vector<uint8_t> out(n);
+
+    auto t0 = chrono::steady_clock::now();
+    size_t denied = 0;
+    const char* deniedMessage = director -> unhandledMessage();
+    for (int d : days) denied += supervisor -> decide(d) == deniedMessage;
+    double dynamicMs = millisSince(t0);
+    cout << "dynamic chain:      " << dynamicMs << " ms, " << n / dynamicMs / 1000 << " M/s (" << denied << " denied)" << endl;
+
+    t0 = chrono::steady_clock::now();
+    denied = 0;
+    for (int d : days) denied += table.resolve(d) == deniedMessage;
+    double resolveMs = millisSince(t0);
+    cout << "branchless resolve: " << resolveMs << " ms, " << n / resolveMs / 1000 << " M/s (" << denied << " denied)" << endl;
+
+    t0 = chrono::steady_clock::now();
+    table.processBatch(days, out);
+    double batchMs = millisSince(t0);
+    denied = 0;
+    for (uint8_t idx : out) denied += table.decision(idx) == deniedMessage;
+    cout << "processBatch:       " << batchMs << " ms, " << n / batchMs / 1000 << " M/s (" << denied << " denied)" << endl;
+
+    return 0;
+}
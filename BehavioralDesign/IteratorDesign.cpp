@@ -4,6 +4,9 @@
 #include <vector>
 #include <algorithm>
 #include <random>
+#include <chrono>
+#include <ranges>
+#include <span>
 #include <string>
 using namespace std;
 
@@ -15,84 +18,222 @@ using namespace std;
 
     We can use Iterator Design Pattern to solve this problem.
     This will help us to follow the Open/Closed Principle.
-    
+
     We can use Iterator Design Pattern to solve this problem.
+
+    getSongs() hands out a span over the playlist's own storage, so
+    iterators never copy songs; next() returns a reference. Playlist
+    keeps a version counter bumped by every change, an iterator
+    remembers the version it started with and throws if the playlist
+    changed under it. PlaylistRange wraps any PlaylistIterator as a
+    C++20 input range, so it composes with views::filter / take.
+
+    The shuffled iterator does not shuffle anything: it maps position
+    i to FeistelPermutation(i), a keyed permutation of [0, n). The
+    first song is ready in O(1) time with O(1) extra memory, and the
+    order is reproducible from the seed.
 */
 
 // --------- Playlist ---------
 class Playlist : public enable_shared_from_this<Playlist> {
 private:
     vector<string> songs;
+    uint64_t modifications = 0;
 public:
     void addSong(const string& song) {
         songs.push_back(song);
+        modifications++;
     }
 
-    vector<string> getSongs() const {
+    // a view, valid until the next modification
+    span<const string> getSongs() const {
         return songs;
     }
 
-    // will be defined later after iterators
-    unique_ptr<class PlaylistIterator> iterator(const string& type);
+    uint64_t version() const {
+        return modifications;
+    }
+
+    // will be defined later after iterators; the seed only matters for "Shuffled"
+    unique_ptr<class PlaylistIterator> iterator(const string& type, uint64_t seed = randomSeed());
+
+    static uint64_t randomSeed() {
+        static mt19937_64 seeds(random_device{}());     // seeded once per process
+        return seeds();
+    }
 };
 
 // --------- Playlist Iterators ---------
 class PlaylistIterator {
 public:
     virtual bool hasNext() = 0;
-    virtual string next() = 0;
+    virtual const string& next() = 0;
     virtual ~PlaylistIterator() {}
 };
 
+class ConcurrentModification : public runtime_error {
+public:
+    ConcurrentModification() : runtime_error("Playlist modified during iteration") {}
+};
+
 class SimplePlaylistIterator : public PlaylistIterator {
 private:
-    int idx;
     shared_ptr<Playlist> playlist;
+    size_t idx;
+    uint64_t expectedVersion;
+
+    void checkVersion() const {
+        if (playlist -> version() != expectedVersion) throw ConcurrentModification();
+    }
 public:
-    SimplePlaylistIterator(shared_ptr<Playlist> p) : playlist(p), idx(0) {}
+    SimplePlaylistIterator(shared_ptr<Playlist> p) : playlist(p), idx(0), expectedVersion(p -> version()) {}
 
     bool hasNext() override {
+        checkVersion();
         return idx < playlist -> getSongs().size();
     }
 
-    string next() override {
-        return playlist -> getSongs().at(idx++);
+    const string& next() override {
+        checkVersion();
+        return playlist -> getSongs()[idx++];
     }
 };
 
-class ShuffledPlaylistIterator : public PlaylistIterator {
+// keyed bijection on [0, n): a balanced Feistel network over the
+// smallest 2k-bit domain that holds n, outputs >= n are fed through
+// again (cycle-walking) until they land inside [0, n)
+class FeistelPermutation {
 private:
-    int idx;
-    vector<string> shuffledSongs;
+    static constexpr int ROUNDS = 6;
+    uint64_t n;
+    int halfBits = 0;
+    uint64_t halfMask;
+    uint64_t keys[ROUNDS];
+
+    static uint64_t splitmix(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t roundFunction(uint64_t half, uint64_t key) const {
+        uint64_t z = (half ^ key) * 0xD6E8FEB86659FD93ULL;
+        return (z ^ (z >> 32)) & halfMask;
+    }
+
+    uint64_t encrypt(uint64_t x) const {
+        uint64_t left = x >> halfBits, right = x & halfMask;
+        for (uint64_t key : keys) {
+            uint64_t next = left ^ roundFunction(right, key);
+            left = right;
+            right = next;
+        }
+        return (left << halfBits) | right;
+    }
 public:
-    ShuffledPlaylistIterator(shared_ptr<Playlist> p) {
-        shuffledSongs = p -> getSongs();
-        random_device rd;
-        mt19937 g(rd());
-        shuffle(shuffledSongs.begin(), shuffledSongs.end(), g);
-        idx = 0;
+    FeistelPermutation(uint64_t n, uint64_t seed) : n(n) {
+        while ((1ULL << (2 * halfBits)) < n) halfBits++;   // domain at most 4n, so ~4 rounds of walking at worst on average
+        halfMask = (1ULL << halfBits) - 1;
+        for (auto& key : keys) key = splitmix(seed);
+    }
+
+    uint64_t operator()(uint64_t i) const {
+        uint64_t x = i;
+        do {
+            x = encrypt(x);
+        } while (x >= n);
+        return x;
+    }
+};
+
+// lazy shuffle: no copy, no up-front work, same seed -> same order
+class ShuffledPlaylistIterator : public PlaylistIterator {
+private:
+    shared_ptr<Playlist> playlist;
+    size_t idx;
+    uint64_t expectedVersion;
+    FeistelPermutation order;
+
+    void checkVersion() const {
+        if (playlist -> version() != expectedVersion) throw ConcurrentModification();
     }
+public:
+    ShuffledPlaylistIterator(shared_ptr<Playlist> p, uint64_t seed)
+        : playlist(p), idx(0), expectedVersion(p -> version()), order(p -> getSongs().size(), seed) {}
 
     bool hasNext() override {
-        return idx < shuffledSongs.size();
+        checkVersion();
+        return idx < playlist -> getSongs().size();
     }
 
-    string next() override {
-        return shuffledSongs.at(idx++);
+    const string& next() override {
+        checkVersion();
+        return playlist -> getSongs()[order(idx++)];
     }
 };
 
 // now implement Playlist::iterator
-unique_ptr<PlaylistIterator> Playlist::iterator(const string& type) {
+unique_ptr<PlaylistIterator> Playlist::iterator(const string& type, uint64_t seed) {
     if (type == "Simple") {
         return make_unique<SimplePlaylistIterator>(shared_from_this());
     } else if (type == "Shuffled") {
-        return make_unique<ShuffledPlaylistIterator>(shared_from_this());
+        return make_unique<ShuffledPlaylistIterator>(shared_from_this(), seed);
     } else {
         throw runtime_error("Invalid iterator type");
     }
 }
 
+// --------- Ranges ---------
+// single-pass view over any PlaylistIterator
+class PlaylistRange : public ranges::view_base {
+private:
+    unique_ptr<PlaylistIterator> source;
+public:
+    class Iterator {
+    private:
+        PlaylistIterator* source = nullptr;
+        const string* current = nullptr;
+    public:
+        using value_type = string;
+        using difference_type = ptrdiff_t;
+
+        Iterator() = default;
+        Iterator(PlaylistIterator* source) : source(source) { ++*this; }
+
+        const string& operator*() const { return *current; }
+
+        Iterator& operator++() {
+            current = source -> hasNext() ? &source -> next() : nullptr;
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        bool operator==(default_sentinel_t) const { return current == nullptr; }
+    };
+
+    PlaylistRange(unique_ptr<PlaylistIterator> source) : source(std::move(source)) {}
+
+    Iterator begin() { return Iterator(source.get()); }
+    default_sentinel_t end() { return default_sentinel; }
+};
+
+static_assert(ranges::input_range<PlaylistRange> && ranges::view<PlaylistRange>);
+
+// --------- Benchmark ---------
+// the old getSongs(): a full copy on every hasNext() and next()
+class CopyingPlaylist {
+private:
+    vector<string> songs;
+public:
+    void addSong(const string& song) { songs.push_back(song); }
+    vector<string> getSongs() const { return songs; }
+};
+
+double millisSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
 // --------- Main ---------
 int main() {
     auto playlist = make_shared<Playlist>();
@@ -114,5 +255,86 @@ int main() {
         cout << shuffledPIT -> next() << endl;
     }
 
+    cout << "\n--- Shuffled, songs starting with S, first 2 ---\n";
+    auto startsWithS = [](const string& song) { return song.starts_with("S"); };
+    for (const string& song : PlaylistRange(playlist -> iterator("Shuffled")) | views::filter(startsWithS) | views::take(2)) {
+        cout << song << endl;
+    }
+
+    cout << "\n--- Shuffled twice with seed 42 ---\n";
+    for (int round = 0; round < 2; round++) {
+        auto it = playlist -> iterator("Shuffled", 42);
+        while (it -> hasNext()) cout << it -> next() << (it -> hasNext() ? ", " : "\n");
+    }
+
+    cout << "\n--- Modified during iteration ---\n";
+    try {
+        auto it = playlist -> iterator("Simple");
+        cout << it -> next() << endl;
+        playlist -> addSong("Kho Gaye Hum Kahan");
+        cout << it -> next() << endl;
+    } catch (const ConcurrentModification& e) {
+        cout << e.what() << endl;
+    }
+
+    cout << "\n--- Benchmark ---\n";
+    {
+        const int n = 2000;
+        CopyingPlaylist old;
+        for (int i = 0; i < n; i++) old.addSong("Song number " + to_string(i));
+        auto t0 = chrono::steady_clock::now();
+        size_t bytes = 0;
+        for (size_t idx = 0; idx < old.getSongs().size(); ) bytes += old.getSongs().at(idx++).size();
+        cout << "copying getSongs(), " << n << " songs: " << millisSince(t0) << " ms (O(n^2), " << bytes << " bytes)" << endl;
+    }
+
+    const int n = 1'000'000;
+    auto big = make_shared<Playlist>();
+    for (int i = 0; i < n; i++) big -> addSong("Song number " + to_string(i));
+
+    for (const char* type : {"Simple", "Shuffled"}) {
+        auto t0 = chrono::steady_clock::now();
+        size_t bytes = 0;
+        auto it = big -> iterator(type);
+        while (it -> hasNext()) bytes += it -> next().size();
+        cout << type << " iterator, " << n << " songs: " << millisSince(t0) << " ms (" << bytes << " bytes)" << endl;
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    auto tens = PlaylistRange(big -> iterator("Simple"))
+              | views::filter([](const string& s) { return s.ends_with("0"); })
+              | views::take(50'000);
+    size_t count = ranges::distance(tens);
+    cout << "ranges filter | take over " << n << " songs: " << millisSince(t0) << " ms (" << count << " songs)" << endl;
+
+    // every position exactly once
+    vector<bool> seen(n);
+    FeistelPermutation perm(n, 7);
+    size_t distinct = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t j = perm(i);
+        if (j < (uint64_t)n && !seen[j]) {
+            seen[j] = true;
+            distinct++;
+        }
+    }
+    cout << "Feistel permutation of " << n << ": " << distinct << " distinct positions" << endl;
+
+    // time to the first song of a 20M entry catalog
+    const uint64_t catalog = 20'000'000;
+    t0 = chrono::steady_clock::now();
+    vector<uint32_t> order(catalog);
+    for (uint32_t i = 0; i < catalog; i++) order[i] = i;
+    shuffle(order.begin(), order.end(), mt19937_64(7));
+    cout << "std::shuffle of " << catalog << " positions: first song after " << millisSince(t0)
+         << " ms, " << (catalog * sizeof(uint32_t) >> 20) << " MB extra" << endl;
+    order = {};
+
+    t0 = chrono::steady_clock::now();
+    FeistelPermutation lazy(catalog, 7);
+    uint64_t first = lazy(0);
+    cout << "Feistel over " << catalog << " positions: first song (" << first << ") after "
+         << millisSince(t0) << " ms, " << sizeof(lazy) << " bytes extra" << endl;
+
     return 0;
 }
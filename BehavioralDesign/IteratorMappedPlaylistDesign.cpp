@@ -0,0 +1,734 @@
+#include <iostream>
+#include <memory>
+#include <exception>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+/*
+    Why a memory-mapped playlist?
+    Playlist in IteratorDesign.cpp is a vector<string>: one heap
+    allocation per title, and loading a 10M song catalog means 10M
+    allocations and copies before the first song plays.
+
+    MappedPlaylist keeps the catalog in one file:
+        [ Header | offsets u64 x (count + 1) | UTF-8 string pool ]
+    Song i is pool[offsets[i], offsets[i + 1]). Opening the file is a
+    single mmap plus one pass that checks the offsets never decrease
+    and stay inside the pool, so songAt() can trust them; titles are
+    string_views straight into the mapping, pool pages are read on
+    demand by the kernel.
+
+    addSong appends to an in-memory delta (its own small pool and
+    offset table, so no per-song allocation either). save() writes
+    base + delta into a new file, renames it over the old one and
+    remaps it. Iterators walk the base and then the delta through
+    songAt(), and check the version counter like IteratorDesign.cpp.
+
+    "Sorted" and "Unique" work on catalogs larger than RAM with an
+    external merge sort under a memory budget: the run phase sorts
+    budget-sized batches of titles and spills them to temporary files,
+    the merge phase reads the runs back through a k-way heap merge
+    (with extra merge passes if there are more runs than buffers fit
+    in the budget). "Unique" drops duplicates as they stream by. The
+    first title is ready right after the run phase.
+*/
+
+// --------- Mapped playlist ---------
+class MappedPlaylist : public enable_shared_from_this<MappedPlaylist> {
+private:
+    static constexpr uint64_t MAGIC = 0x31545349'4C59414CULL;    // "LAYLIST1"
+
+    struct Header {
+        uint64_t magic;
+        uint64_t count;
+        uint64_t poolBytes;
+    };
+
+    string path;
+    int fd = -1;
+    char* map = nullptr;
+    size_t mappedBytes = 0;
+    uint64_t baseCount = 0;
+    const uint64_t* baseOffsets = nullptr;
+    const char* basePool = nullptr;
+
+    vector<char> deltaPool;
+    vector<uint64_t> deltaOffsets{0};
+    uint64_t modifications = 0;
+
+    size_t sortBudget = 64 << 20;       // bytes of titles the sort may hold at once
+    string spillDir = "/tmp";
+
+    void unmap() {
+        if (map) munmap(map, mappedBytes);
+        if (fd >= 0) close(fd);
+        map = nullptr;
+        fd = -1;
+        baseCount = 0;
+    }
+
+    void mapFile() {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (errno == ENOENT) return;        // a new, empty playlist
+            throw runtime_error("Cannot open " + path + ": " + strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            string reason = strerror(errno);
+            unmap();
+            throw runtime_error("Cannot stat " + path + ": " + reason);
+        }
+        mappedBytes = st.st_size;
+        if (mappedBytes < sizeof(Header)) {
+            unmap();
+            throw runtime_error("Not a playlist file: " + path);
+        }
+        void* p = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            string reason = strerror(errno);
+            unmap();
+            throw runtime_error("mmap failed: " + reason);
+        }
+        map = static_cast<char*>(p);
+
+        Header h;
+        memcpy(&h, map, sizeof(h));
+        size_t tableSlots = (mappedBytes - sizeof(Header)) / sizeof(uint64_t);
+        if (h.magic != MAGIC || h.count >= tableSlots ||
+            sizeof(Header) + (h.count + 1) * sizeof(uint64_t) + h.poolBytes != mappedBytes) {
+            unmap();
+            throw runtime_error("Corrupt playlist file: " + path);
+        }
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(map + sizeof(Header));
+
+        // once here, so songAt() never reads outside the pool
+        bool valid = offsets[0] == 0 && offsets[h.count] == h.poolBytes;
+        for (uint64_t i = 0; valid && i < h.count; i++) valid = offsets[i] <= offsets[i + 1];
+        if (!valid) {
+            unmap();
+            throw runtime_error("Corrupt offset table: " + path);
+        }
+        baseCount = h.count;
+        baseOffsets = offsets;
+        basePool = map + sizeof(Header) + (h.count + 1) * sizeof(uint64_t);
+    }
+
+    static bool validUtf8(string_view s) {
+        for (size_t i = 0; i < s.size(); ) {
+            unsigned char c = s[i];
+            int extra = c < 0x80 ? 0 : (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xE ? 2 : (c >> 3) == 0x1E ? 3 : -1;
+            if (extra < 0 || i + extra >= s.size()) return false;
+            for (int k = 1; k <= extra; k++) {
+                if (((unsigned char)s[i + k] >> 6) != 0x2) return false;
+            }
+            i += extra + 1;
+        }
+        return true;
+    }
+
+    static void writeAll(int out, const void* data, size_t n) {
+        const char* p = static_cast<const char*>(data);
+        while (n > 0) {
+            ssize_t w = write(out, p, n);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                throw runtime_error("write failed: " + string(strerror(errno)));
+            }
+            p += w;
+            n -= w;
+        }
+    }
+
+public:
+    MappedPlaylist(string path) : path(std::move(path)) {
+        mapFile();
+    }
+
+    ~MappedPlaylist() { unmap(); }
+
+    MappedPlaylist(const MappedPlaylist&) = delete;
+    MappedPlaylist& operator=(const MappedPlaylist&) = delete;
+
+    void addSong(string_view song) {
+        if (!validUtf8(song)) throw invalid_argument("Song title is not valid UTF-8");
+        deltaPool.insert(deltaPool.end(), song.begin(), song.end());
+        deltaOffsets.push_back(deltaPool.size());
+        modifications++;
+    }
+
+    uint64_t size() const { return baseCount + deltaOffsets.size() - 1; }
+    uint64_t pendingSongs() const { return deltaOffsets.size() - 1; }
+    uint64_t version() const { return modifications; }
+
+    string_view songAt(uint64_t i) const {
+        if (i < baseCount) return string_view(basePool + baseOffsets[i], baseOffsets[i + 1] - baseOffsets[i]);
+        i -= baseCount;
+        return string_view(deltaPool.data() + deltaOffsets[i], deltaOffsets[i + 1] - deltaOffsets[i]);
+    }
+
+    // merges the delta into a new file, renames it into place and remaps
+    void save() {
+        uint64_t basePoolBytes = baseCount ? baseOffsets[baseCount] : 0;
+        Header h{MAGIC, size(), basePoolBytes + deltaPool.size()};
+
+        string tmp = path + ".tmp";
+        int out = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) throw runtime_error("Cannot create " + tmp + ": " + strerror(errno));
+        try {
+            writeAll(out, &h, sizeof(h));
+            if (baseCount) writeAll(out, baseOffsets, baseCount * sizeof(uint64_t));
+            vector<uint64_t> shifted(deltaOffsets.size());
+            for (size_t i = 0; i < deltaOffsets.size(); i++) shifted[i] = basePoolBytes + deltaOffsets[i];
+            writeAll(out, shifted.data(), shifted.size() * sizeof(uint64_t));
+            if (basePoolBytes) writeAll(out, basePool, basePoolBytes);
+            writeAll(out, deltaPool.data(), deltaPool.size());
+            if (fsync(out) < 0) throw runtime_error("fsync failed");
+        }
+        catch (...) {
+            close(out);
+            unlink(tmp.c_str());
+            throw;
+        }
+        close(out);
+        if (rename(tmp.c_str(), path.c_str()) < 0) throw runtime_error("rename failed: " + string(strerror(errno)));
+
+        unmap();
+        mapFile();
+        vector<char>().swap(deltaPool);
+        deltaOffsets.assign(1, 0);
+        modifications++;            // song positions are the same, but open iterators hold old pointers
+    }
+
+    // memory budget and scratch directory for "Sorted" / "Unique"
+    void setSortBudget(size_t bytes, const string& dir = "/tmp") {
+        sortBudget = bytes;
+        spillDir = dir;
+    }
+    size_t getSortBudget() const { return sortBudget; }
+    const string& getSpillDir() const { return spillDir; }
+
+    // will be defined later after iterators; the seed only matters for "Shuffled"
+    unique_ptr<class PlaylistIterator> iterator(const string& type, uint64_t seed = randomSeed());
+
+    static uint64_t randomSeed() {
+        static mt19937_64 seeds(random_device{}());
+        return seeds();
+    }
+};
+
+// --------- Playlist Iterators ---------
+class PlaylistIterator {
+public:
+    virtual bool hasNext() = 0;
+    virtual string_view next() = 0;     // points into the mapped pool
+    virtual ~PlaylistIterator() {}
+};
+
+class ConcurrentModification : public runtime_error {
+public:
+    ConcurrentModification() : runtime_error("Playlist modified during iteration") {}
+};
+
+class SimplePlaylistIterator : public PlaylistIterator {
+private:
+    shared_ptr<MappedPlaylist> playlist;
+    uint64_t idx;
+    uint64_t expectedVersion;
+
+    void checkVersion() const {
+        if (playlist -> version() != expectedVersion) throw ConcurrentModification();
+    }
+public:
+    SimplePlaylistIterator(shared_ptr<MappedPlaylist> p) : playlist(p), idx(0), expectedVersion(p -> version()) {}
+
+    bool hasNext() override {
+        checkVersion();
+        return idx < playlist -> size();
+    }
+
+    string_view next() override {
+        checkVersion();
+        return playlist -> songAt(idx++);
+    }
+};
+
+// keyed bijection on [0, n), see IteratorDesign.cpp
+class FeistelPermutation {
+private:
+    static constexpr int ROUNDS = 6;
+    uint64_t n;
+    int halfBits = 0;
+    uint64_t halfMask;
+    uint64_t keys[ROUNDS];
+
+    static uint64_t splitmix(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t roundFunction(uint64_t half, uint64_t key) const {
+        uint64_t z = (half ^ key) * 0xD6E8FEB86659FD93ULL;
+        return (z ^ (z >> 32)) & halfMask;
+    }
+
+    uint64_t encrypt(uint64_t x) const {
+        uint64_t left = x >> halfBits, right = x & halfMask;
+        for (uint64_t key : keys) {
+            uint64_t next = left ^ roundFunction(right, key);
+            left = right;
+            right = next;
+        }
+        return (left << halfBits) | right;
+    }
+public:
+    FeistelPermutation(uint64_t n, uint64_t seed) : n(n) {
+        while ((1ULL << (2 * halfBits)) < n) halfBits++;
+        halfMask = (1ULL << halfBits) - 1;
+        for (auto& key : keys) key = splitmix(seed);
+    }
+
+    uint64_t operator()(uint64_t i) const {
+        uint64_t x = i;
+        do {
+            x = encrypt(x);
+        } while (x >= n);
+        return x;
+    }
+};
+
+class ShuffledPlaylistIterator : public PlaylistIterator {
+private:
+    shared_ptr<MappedPlaylist> playlist;
+    uint64_t idx;
+    uint64_t expectedVersion;
+    FeistelPermutation order;
+
+    void checkVersion() const {
+        if (playlist -> version() != expectedVersion) throw ConcurrentModification();
+    }
+public:
+    ShuffledPlaylistIterator(shared_ptr<MappedPlaylist> p, uint64_t seed)
+        : playlist(p), idx(0), expectedVersion(p -> version()), order(p -> size(), seed) {}
+
+    bool hasNext() override {
+        checkVersion();
+        return idx < playlist -> size();
+    }
+
+    string_view next() override {
+        checkVersion();
+        return playlist -> songAt(order(idx++));
+    }
+};
+
+// --------- External sort ---------
+// a spilled run: [ length u32 | bytes ] records in a file that is
+// unlinked as soon as it is created, so it disappears with the fd
+class RunWriter {
+private:
+    int fd;
+    vector<char> buffer;
+    size_t used = 0;
+
+    void flush() {
+        for (size_t done = 0; done < used; ) {
+            ssize_t w = write(fd, buffer.data() + done, used - done);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                throw runtime_error("spill write failed: " + string(strerror(errno)));
+            }
+            done += w;
+        }
+        used = 0;
+    }
+public:
+    RunWriter(const string& dir, size_t bufferBytes) : buffer(max<size_t>(bufferBytes, 4096)) {
+        string name = dir + "/runXXXXXX";
+        fd = mkstemp(name.data());
+        if (fd < 0) throw runtime_error("Cannot create spill file in " + dir + ": " + strerror(errno));
+        unlink(name.c_str());
+    }
+
+    ~RunWriter() { if (fd >= 0) close(fd); }
+
+    void add(string_view song) {
+        uint32_t length = song.size();
+        if (used + sizeof(length) + length > buffer.size()) flush();
+        if (sizeof(length) + length > buffer.size()) buffer.resize(sizeof(length) + length);
+        memcpy(buffer.data() + used, &length, sizeof(length));
+        memcpy(buffer.data() + used + sizeof(length), song.data(), length);
+        used += sizeof(length) + length;
+    }
+
+    // hands the file over to a reader
+    int finish() {
+        flush();
+        int out = fd;
+        fd = -1;
+        return out;
+    }
+};
+
+class RunReader {
+private:
+    int fd;
+    off_t offset = 0;
+    vector<char> buffer;
+    size_t pos = 0, filled = 0;
+
+    // makes at least n bytes available, false at the end of the run
+    bool ensure(size_t n) {
+        if (filled - pos >= n) return true;
+        memmove(buffer.data(), buffer.data() + pos, filled - pos);
+        filled -= pos;
+        pos = 0;
+        if (buffer.size() < n) buffer.resize(n);
+        while (filled < n) {
+            ssize_t r = pread(fd, buffer.data() + filled, buffer.size() - filled, offset);
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) throw runtime_error("spill read failed: " + string(strerror(errno)));
+            if (r == 0) return false;
+            filled += r;
+            offset += r;
+        }
+        return true;
+    }
+public:
+    RunReader(int fd, size_t bufferBytes) : fd(fd), buffer(max<size_t>(bufferBytes, 4096)) {}
+    ~RunReader() { close(fd); }
+
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+
+    bool next(string& out) {
+        uint32_t length;
+        if (!ensure(sizeof(length))) return false;
+        memcpy(&length, buffer.data() + pos, sizeof(length));
+        if (!ensure(sizeof(length) + length)) throw runtime_error("truncated spill file");
+        out.assign(buffer.data() + pos + sizeof(length), length);
+        pos += sizeof(length) + length;
+        return true;
+    }
+};
+
+// k-way merge over sorted runs, a min-heap of run indices keyed by each run's head
+class RunMerger {
+private:
+    vector<unique_ptr<RunReader>> runs;
+    vector<string> heads;
+    vector<size_t> heap;
+
+    bool greater(size_t a, size_t b) const {
+        int c = heads[a].compare(heads[b]);
+        return c > 0 || (c == 0 && a > b);     // ties keep run order
+    }
+public:
+    RunMerger(vector<unique_ptr<RunReader>> readers) : runs(std::move(readers)), heads(runs.size()) {
+        for (size_t r = 0; r < runs.size(); r++) {
+            if (runs[r] -> next(heads[r])) heap.push_back(r);
+        }
+        auto cmp = [this](size_t a, size_t b) { return greater(a, b); };
+        make_heap(heap.begin(), heap.end(), cmp);
+    }
+
+    bool pop(string& out) {
+        if (heap.empty()) return false;
+        auto cmp = [this](size_t a, size_t b) { return greater(a, b); };
+        pop_heap(heap.begin(), heap.end(), cmp);
+        size_t r = heap.back();
+        swap(out, heads[r]);
+        if (runs[r] -> next(heads[r])) push_heap(heap.begin(), heap.end(), cmp);
+        else heap.pop_back();
+        return true;
+    }
+};
+
+class SortedPlaylistIterator : public PlaylistIterator {
+private:
+    static constexpr size_t MIN_BUFFER = 64 << 10;
+
+    shared_ptr<MappedPlaylist> playlist;
+    uint64_t expectedVersion;
+    bool unique;
+
+    vector<string_view> memoryRun;      // everything fit in the budget, nothing spilled
+    size_t memoryIdx = 0;
+    unique_ptr<RunMerger> merger;
+
+    string current, pending;
+    bool ready = false, emitted = false;
+    size_t spilledRuns = 0, mergePasses = 0;
+
+    void checkVersion() const {
+        if (playlist -> version() != expectedVersion) throw ConcurrentModification();
+    }
+
+    static int spill(vector<string_view>& run, const string& dir, size_t bufferBytes) {
+        sort(run.begin(), run.end());
+        RunWriter writer(dir, bufferBytes);
+        for (auto song : run) writer.add(song);
+        return writer.finish();
+    }
+
+    bool pull(string& out) {
+        if (merger) return merger -> pop(out);
+        if (memoryIdx == memoryRun.size()) return false;
+        out.assign(memoryRun[memoryIdx++]);
+        return true;
+    }
+
+    // next title in order, skipping repeats of the last one handed out for "Unique"
+    bool fetch(string& out) {
+        while (pull(out)) {
+            if (!unique || !emitted || out != current) return true;
+        }
+        return false;
+    }
+public:
+    SortedPlaylistIterator(shared_ptr<MappedPlaylist> p, bool unique)
+        : playlist(p), expectedVersion(p -> version()), unique(unique) {
+        size_t budget = p -> getSortBudget();
+        const string& dir = p -> getSpillDir();
+
+        // run phase
+        vector<int> runs;
+        vector<string_view> run;
+        size_t used = 0;
+        for (uint64_t i = 0; i < p -> size(); i++) {
+            string_view song = p -> songAt(i);
+            run.push_back(song);
+            used += song.size() + sizeof(string_view);
+            if (used >= budget) {
+                runs.push_back(spill(run, dir, MIN_BUFFER));
+                run.clear();
+                used = 0;
+            }
+        }
+        if (runs.empty()) {
+            sort(run.begin(), run.end());
+            memoryRun = std::move(run);
+        }
+        else {
+            if (!run.empty()) runs.push_back(spill(run, dir, MIN_BUFFER));
+            vector<string_view>().swap(run);
+            spilledRuns = runs.size();
+
+            // merge passes until every run gets a read buffer within the budget
+            size_t fanIn = max<size_t>(3, budget / MIN_BUFFER) - 1;
+            while (runs.size() > fanIn) {
+                vector<int> merged;
+                for (size_t first = 0; first < runs.size(); first += fanIn) {
+                    size_t last = min(runs.size(), first + fanIn);
+                    if (last - first == 1) {
+                        merged.push_back(runs[first]);
+                        continue;
+                    }
+                    vector<unique_ptr<RunReader>> group;
+                    for (size_t r = first; r < last; r++) group.push_back(make_unique<RunReader>(runs[r], MIN_BUFFER));
+                    RunMerger pass(std::move(group));
+                    RunWriter writer(dir, MIN_BUFFER);
+                    string song;
+                    while (pass.pop(song)) writer.add(song);
+                    merged.push_back(writer.finish());
+                }
+                runs = std::move(merged);
+                mergePasses++;
+            }
+
+            size_t bufferBytes = max(MIN_BUFFER, budget / (runs.size() + 1));
+            vector<unique_ptr<RunReader>> readers;
+            for (int fd : runs) readers.push_back(make_unique<RunReader>(fd, bufferBytes));
+            merger = make_unique<RunMerger>(std::move(readers));
+        }
+        ready = fetch(pending);
+    }
+
+    bool hasNext() override {
+        checkVersion();
+        return ready;
+    }
+
+    // valid until the following next()
+    string_view next() override {
+        checkVersion();
+        if (!ready) throw out_of_range("no more songs");
+        swap(current, pending);
+        emitted = true;
+        ready = fetch(pending);
+        return current;
+    }
+
+    size_t runsSpilled() const { return spilledRuns; }
+    size_t extraMergePasses() const { return mergePasses; }
+};
+
+// now implement MappedPlaylist::iterator
+unique_ptr<PlaylistIterator> MappedPlaylist::iterator(const string& type, uint64_t seed) {
+    if (type == "Simple") {
+        return make_unique<SimplePlaylistIterator>(shared_from_this());
+    } else if (type == "Shuffled") {
+        return make_unique<ShuffledPlaylistIterator>(shared_from_this(), seed);
+    } else if (type == "Sorted") {
+        return make_unique<SortedPlaylistIterator>(shared_from_this(), false);
+    } else if (type == "Unique") {
+        return make_unique<SortedPlaylistIterator>(shared_from_this(), true);
+    } else {
+        throw runtime_error("Invalid iterator type");
+    }
+}
+
+// --------- Benchmark ---------
+double millisSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// what loading into IteratorDesign.cpp's vector<string> would cost
+vector<string> loadAsStrings(const string& path) {
+    MappedPlaylist file(path);
+    vector<string> songs;
+    songs.reserve(file.size());
+    for (uint64_t i = 0; i < file.size(); i++) songs.emplace_back(file.songAt(i));
+    return songs;
+}
+
+// --------- Main ---------
+int main() {
+    char dir[] = "/tmp/playlistXXXXXX";
+    if (!mkdtemp(dir)) throw runtime_error("mkdtemp failed");
+    string path = string(dir) + "/favourites.playlist";
+
+    {
+        auto playlist = make_shared<MappedPlaylist>(path);
+        playlist -> addSong("Sajna Barse");
+        playlist -> addSong("Shaam Se");
+        playlist -> addSong("Jee Na Paye");
+        playlist -> save();
+        playlist -> addSong("Gazab Ka Hai Din");    // still in the delta
+        playlist -> addSong("Rait Zara Si");
+
+        cout << "--- Simple (3 mapped + " << playlist -> pendingSongs() << " in the delta) ---\n";
+        auto simplePIT = playlist -> iterator("Simple");
+        while (simplePIT -> hasNext()) {
+            cout << simplePIT -> next() << endl;
+        }
+        playlist -> save();
+    }
+    {
+        auto playlist = make_shared<MappedPlaylist>(path);
+        cout << "\n--- Shuffled, after reopening ---\n";
+        auto shuffledPIT = playlist -> iterator("Shuffled");
+        while (shuffledPIT -> hasNext()) {
+            cout << shuffledPIT -> next() << endl;
+        }
+        try {
+            playlist -> addSong("\xC3\x28");
+        } catch (const invalid_argument& e) {
+            cout << e.what() << endl;
+        }
+
+        playlist -> addSong("Shaam Se");
+        playlist -> setSortBudget(64, dir);         // a few titles per run, forces spills and merge passes
+        for (const char* type : {"Sorted", "Unique"}) {
+            cout << "\n--- " << type << " ---\n";
+            auto sortedPIT = playlist -> iterator(type);
+            while (sortedPIT -> hasNext()) {
+                cout << sortedPIT -> next() << endl;
+            }
+        }
+    }
+    unlink(path.c_str());
+
+    const uint64_t n = 10'000'000;
+    cout << "\n--- " << n << " song catalog ---\n";
+    {
+        auto catalog = make_shared<MappedPlaylist>(path);
+        auto t0 = chrono::steady_clock::now();
+        for (uint64_t i = 0; i < n; i++) catalog -> addSong("Song number " + to_string(i));
+        catalog -> save();
+        struct stat st;
+        stat(path.c_str(), &st);
+        cout << "build + save: " << millisSince(t0) << " ms, " << (st.st_size >> 20) << " MB file" << endl;
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    auto catalog = make_shared<MappedPlaylist>(path);
+    cout << "open mapped: " << millisSince(t0) << " ms" << endl;
+
+    t0 = chrono::steady_clock::now();
+    {
+        vector<string> loaded = loadAsStrings(path);
+        cout << "load into vector<string>: " << millisSince(t0) << " ms, " << loaded.size() << " allocations" << endl;
+    }
+
+    for (const char* type : {"Simple", "Shuffled"}) {
+        t0 = chrono::steady_clock::now();
+        size_t bytes = 0;
+        auto it = catalog -> iterator(type);
+        while (it -> hasNext()) bytes += it -> next().size();
+        cout << type << " over the mapping: " << millisSince(t0) << " ms (" << (bytes >> 20) << " MB of titles)" << endl;
+    }
+
+    t0 = chrono::steady_clock::now();
+    auto it = catalog -> iterator("Shuffled", 3);
+    string_view first = it -> next();
+    cout << "first shuffled song: " << first << " after " << millisSince(t0) << " ms" << endl;
+
+    catalog.reset();
+    unlink(path.c_str());
+
+    // external sort: n titles drawn from n / 4 distinct ones, 32 MB budget
+    {
+        auto duplicates = make_shared<MappedPlaylist>(path);
+        mt19937_64 rng(7);
+        for (uint64_t i = 0; i < n; i++) duplicates -> addSong("Song number " + to_string(rng() % (n / 4)));
+        duplicates -> save();
+    }
+    catalog = make_shared<MappedPlaylist>(path);
+    catalog -> setSortBudget(32 << 20, dir);
+
+    for (bool unique : {false, true}) {
+        t0 = chrono::steady_clock::now();
+        SortedPlaylistIterator sorted(catalog, unique);
+        double firstMs = millisSince(t0);
+        string previous;
+        size_t count = 0, outOfOrder = 0;
+        while (sorted.hasNext()) {
+            string_view song = sorted.next();
+            if (count && (unique ? song <= previous : song < previous)) outOfOrder++;
+            previous = song;
+            count++;
+        }
+        cout << (unique ? "Unique" : "Sorted") << ", 32 MB budget: " << sorted.runsSpilled() << " runs, "
+             << sorted.extraMergePasses() << " extra passes, first song after " << firstMs << " ms, all "
+             << count << " after " << millisSince(t0) << " ms (" << outOfOrder << " out of order)" << endl;
+    }
+
+    t0 = chrono::steady_clock::now();
+    {
+        vector<string> loaded = loadAsStrings(path);
+        sort(loaded.begin(), loaded.end());
+        size_t distinct = unique(loaded.begin(), loaded.end()) - loaded.begin();
+        cout << "in-memory std::sort of vector<string>: " << millisSince(t0) << " ms, " << distinct
+             << " distinct, ~" << ((loaded.capacity() * sizeof(string)) >> 20) << " MB of strings" << endl;
+    }
+
+    catalog.reset();
+    unlink(path.c_str());
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,439 @@
+#include <iostream>
+#include <memory>
+#include <exception>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <string>
+using namespace std;
+
+/*
+    Why a multi-version playlist?
+    Playlist in IteratorDesign.cpp is one vector<string>; addSong while
+    a listener iterates may reallocate it under the iterator. In the
+    service playlists are edited while many listeners stream them.
+
+    MvccPlaylist keeps immutable versions:
+    - songs live in immutable chunks of CHUNK titles, a Version is a
+      table of chunk pointers plus a size
+    - a writer copies only the chunks it touches and the chunk table,
+      builds the new Version and publishes it with one atomic store
+    - an iterator pins the Version that was current when it was
+      created and reads it to the end, no matter what writers do
+
+    Reclamation is epoch based. A reader announces the global epoch in
+    a slot before loading the current Version and clears the slot when
+    the iterator dies. A writer that replaces a Version retires the old
+    Version and the chunks it no longer shares, tagged with the epoch
+    it bumped; they are freed once every announced epoch is newer.
+    Readers only do atomic loads and stores, never take a lock.
+    A snapshot also holds a shared_ptr to its playlist, so an iterator
+    may outlive every other owner; playlists are therefore always
+    owned by a shared_ptr (make_shared).
+*/
+
+// --------- Epochs ---------
+class EpochDomain {
+private:
+    static constexpr uint64_t IDLE = UINT64_MAX;
+    static constexpr size_t SLOTS = 256;
+
+    struct alignas(64) Slot {
+        atomic<uint64_t> epoch{IDLE};
+    };
+
+    atomic<uint64_t> global{1};
+    Slot slots[SLOTS];
+public:
+    class Guard {
+    private:
+        EpochDomain* domain = nullptr;
+        size_t slot = 0;
+    public:
+        Guard() = default;
+        Guard(EpochDomain* domain, size_t slot) : domain(domain), slot(slot) {}
+        Guard(Guard&& other) noexcept : domain(other.domain), slot(other.slot) { other.domain = nullptr; }
+        Guard& operator=(Guard&& other) noexcept {
+            swap(domain, other.domain);
+            swap(slot, other.slot);
+            return *this;
+        }
+        ~Guard() {
+            if (domain) domain -> slots[slot].epoch.store(IDLE, memory_order_release);
+        }
+    };
+
+    // announce the current epoch; everything loaded afterwards stays alive
+    Guard pin() {
+        for (size_t i = 0; i < SLOTS; i++) {
+            uint64_t idle = IDLE;
+            uint64_t now = global.load();
+            if (slots[i].epoch.load(memory_order_relaxed) == IDLE &&
+                slots[i].epoch.compare_exchange_strong(idle, now)) {
+                // seq_cst: the announcement is visible before we load any shared pointer
+                return Guard(this, i);
+            }
+        }
+        throw runtime_error("too many concurrent readers");
+    }
+
+    // writers: the epoch that retired objects are tagged with
+    uint64_t advance() { return global.fetch_add(1); }
+
+    // objects retired at an epoch below this are unreachable
+    uint64_t oldestPinned() const {
+        uint64_t oldest = global.load();
+        for (auto& s : slots) oldest = min(oldest, s.epoch.load());
+        return oldest;
+    }
+};
+
+// --------- Versions ---------
+class MvccPlaylist : public enable_shared_from_this<MvccPlaylist> {
+public:
+    static constexpr size_t CHUNK = 256;
+
+    struct Chunk {
+        vector<string> songs;
+    };
+
+    struct Version {
+        uint64_t number;
+        size_t size;
+        vector<const Chunk*> chunks;
+
+        const string& at(size_t i) const { return chunks[i / CHUNK] -> songs[i % CHUNK]; }
+    };
+
+private:
+    struct Retired {
+        uint64_t epoch;
+        const Version* version;
+        vector<const Chunk*> chunks;    // chunks the replacing version no longer uses
+    };
+
+    atomic<const Version*> current;
+    EpochDomain epochs;
+    mutex writer;                       // writers serialize, readers never touch it
+    vector<Retired> retired;
+    size_t chunksFreed = 0, versionsFreed = 0;
+
+    void publish(unique_ptr<Version> next, vector<const Chunk*> replaced) {
+        const Version* old = current.load(memory_order_relaxed);
+        next -> number = old -> number + 1;
+        current.store(next.release());
+        retired.push_back({epochs.advance(), old, std::move(replaced)});
+        reclaim();
+    }
+
+    void reclaim() {
+        uint64_t oldest = epochs.oldestPinned();
+        size_t kept = 0;
+        for (auto& r : retired) {
+            if (r.epoch < oldest) {
+                for (auto* c : r.chunks) delete c;
+                delete r.version;
+                chunksFreed += r.chunks.size();
+                versionsFreed++;
+            }
+            else {
+                if (&retired[kept] != &r) retired[kept] = std::move(r);
+                kept++;
+            }
+        }
+        retired.resize(kept);
+    }
+
+public:
+    MvccPlaylist() {
+        current.store(new Version{0, 0, {}});
+    }
+
+    ~MvccPlaylist() {
+        for (auto& r : retired) {
+            for (auto* c : r.chunks) delete c;
+            delete r.version;
+        }
+        const Version* v = current.load();
+        for (auto* c : v -> chunks) delete c;
+        delete v;
+    }
+
+    // copies the last chunk (or starts a new one) and the chunk table
+    void addSong(const string& song) {
+        lock_guard<mutex> guard(writer);
+        const Version* old = current.load(memory_order_relaxed);
+        auto next = make_unique<Version>(*old);
+        vector<const Chunk*> replaced;
+        if (old -> size % CHUNK == 0) {
+            auto chunk = new Chunk();
+            chunk -> songs.reserve(CHUNK);
+            chunk -> songs.push_back(song);
+            next -> chunks.push_back(chunk);
+        }
+        else {
+            const Chunk* last = old -> chunks.back();
+            auto chunk = new Chunk(*last);
+            chunk -> songs.push_back(song);
+            next -> chunks.back() = chunk;
+            replaced.push_back(last);
+        }
+        next -> size++;
+        publish(std::move(next), std::move(replaced));
+    }
+
+    // copies only the chunk that holds position i
+    void replaceSong(size_t i, const string& song) {
+        lock_guard<mutex> guard(writer);
+        const Version* old = current.load(memory_order_relaxed);
+        if (i >= old -> size) throw out_of_range("no song at " + to_string(i));
+        auto next = make_unique<Version>(*old);
+        const Chunk* touched = old -> chunks[i / CHUNK];
+        auto chunk = new Chunk(*touched);
+        chunk -> songs[i % CHUNK] = song;
+        next -> chunks[i / CHUNK] = chunk;
+        publish(std::move(next), {touched});
+    }
+
+    // a pinned, immutable view of the current version
+    class Snapshot {
+    private:
+        shared_ptr<const MvccPlaylist> owner;   // declared first: the guard is released before the playlist can go
+        EpochDomain::Guard guard;
+        const Version* version;
+    public:
+        Snapshot(shared_ptr<const MvccPlaylist> owner, EpochDomain::Guard guard, const Version* version)
+            : owner(std::move(owner)), guard(std::move(guard)), version(version) {}
+        size_t size() const { return version -> size; }
+        uint64_t number() const { return version -> number; }
+        const string& operator[](size_t i) const { return version -> at(i); }
+    };
+
+    // throws bad_weak_ptr unless the playlist is owned by a shared_ptr
+    Snapshot snapshot() {
+        auto owner = shared_from_this();
+        auto guard = epochs.pin();
+        return Snapshot(std::move(owner), std::move(guard), current.load());
+    }
+
+    size_t retiredBacklog() {
+        lock_guard<mutex> guard(writer);
+        return retired.size();
+    }
+
+    size_t freedChunks() {
+        lock_guard<mutex> guard(writer);
+        return chunksFreed;
+    }
+
+    // will be defined later after iterators
+    unique_ptr<class PlaylistIterator> iterator(const string& type);
+};
+
+// --------- Playlist Iterators ---------
+class PlaylistIterator {
+public:
+    virtual bool hasNext() = 0;
+    virtual const string& next() = 0;   // valid while the iterator lives
+    virtual ~PlaylistIterator() {}
+};
+
+class SimplePlaylistIterator : public PlaylistIterator {
+private:
+    MvccPlaylist::Snapshot snapshot;
+    size_t idx = 0;
+public:
+    SimplePlaylistIterator(MvccPlaylist::Snapshot s) : snapshot(std::move(s)) {}
+
+    bool hasNext() override {
+        return idx < snapshot.size();
+    }
+
+    const string& next() override {
+        return snapshot[idx++];
+    }
+};
+
+class ShuffledPlaylistIterator : public PlaylistIterator {
+private:
+    MvccPlaylist::Snapshot snapshot;
+    size_t idx = 0;
+    vector<uint32_t> order;
+public:
+    ShuffledPlaylistIterator(MvccPlaylist::Snapshot s) : snapshot(std::move(s)) {
+        order.resize(snapshot.size());
+        for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+        static thread_local mt19937 g(random_device{}());
+        shuffle(order.begin(), order.end(), g);
+    }
+
+    bool hasNext() override {
+        return idx < order.size();
+    }
+
+    const string& next() override {
+        return snapshot[order[idx++]];
+    }
+};
+
+// now implement MvccPlaylist::iterator
+unique_ptr<PlaylistIterator> MvccPlaylist::iterator(const string& type) {
+    if (type == "Simple") {
+        return make_unique<SimplePlaylistIterator>(snapshot());
+    } else if (type == "Shuffled") {
+        return make_unique<ShuffledPlaylistIterator>(snapshot());
+    } else {
+        throw runtime_error("Invalid iterator type");
+    }
+}
+
+// --------- Benchmark ---------
+// the obvious alternative: readers hold a shared lock for the whole walk
+class LockedPlaylist {
+private:
+    vector<string> songs;
+    shared_mutex lock;
+public:
+    void addSong(const string& song) {
+        unique_lock<shared_mutex> guard(lock);
+        songs.push_back(song);
+    }
+    void replaceSong(size_t i, const string& song) {
+        unique_lock<shared_mutex> guard(lock);
+        songs.at(i) = song;
+    }
+    template <typename Fn>
+    void scan(Fn&& fn) {
+        shared_lock<shared_mutex> guard(lock);
+        for (auto& s : songs) fn(s);
+    }
+};
+
+string title(size_t i, int revision) {
+    return "Song " + to_string(i) + " rev " + to_string(revision);
+}
+
+// song i must always be some revision of "Song i"
+bool consistent(const string& song, size_t i) {
+    string prefix = "Song " + to_string(i) + " ";
+    return song.compare(0, prefix.size(), prefix) == 0;
+}
+
+int main() {
+    auto playlist = make_shared<MvccPlaylist>();
+    playlist -> addSong("Sajna Barse");
+    playlist -> addSong("Shaam Se");
+    playlist -> addSong("Jee Na Paye");
+
+    cout << "--- Simple, while the playlist is edited ---\n";
+    auto simplePIT = playlist -> iterator("Simple");
+    playlist -> addSong("Gazab Ka Hai Din");
+    playlist -> replaceSong(0, "Sajna Barse (Live)");
+    while (simplePIT -> hasNext()) {
+        cout << simplePIT -> next() << endl;     // still the version it started with
+    }
+
+    cout << "\n--- Shuffled, new version ---\n";
+    auto shuffledPIT = playlist -> iterator("Shuffled");
+    while (shuffledPIT -> hasNext()) {
+        cout << shuffledPIT -> next() << endl;
+    }
+    simplePIT.reset();
+    shuffledPIT.reset();
+    playlist -> addSong("Rait Zara Si");
+    cout << "retired versions still waiting: " << playlist -> retiredBacklog() << endl;
+
+    // the iterator keeps the playlist alive after its last other owner is gone
+    auto orphan = playlist -> iterator("Simple");
+    playlist.reset();
+    size_t left = 0;
+    while (orphan -> hasNext()) left += !orphan -> next().empty();
+    cout << "songs read after the playlist was released: " << left << endl;
+    orphan.reset();
+
+    const size_t initial = 100'000;
+    const int readers = 4;
+    const auto runFor = chrono::milliseconds(1500);
+    cout << "\n--- " << initial << " songs, " << readers << " readers scanning, 1 writer editing ---\n";
+
+    // MVCC
+    {
+        auto big = make_shared<MvccPlaylist>();
+        for (size_t i = 0; i < initial; i++) big -> addSong(title(i, 0));
+
+        auto deadline = chrono::steady_clock::now() + runFor;     // readers stop on their own, so a starved writer gets through
+        atomic<long> scans{0}, bad{0};
+        atomic<size_t> totalBytes{0};
+        vector<thread> threads;
+        for (int r = 0; r < readers; r++) {
+            threads.emplace_back([&] {
+                while (chrono::steady_clock::now() < deadline) {
+                    auto it = big -> iterator("Simple");
+                    size_t i = 0, bytes = 0;
+                    while (it -> hasNext()) {
+                        const string& song = it -> next();
+                        bytes += song.size();
+                        if (i++ % 1024 == 0 && !consistent(song, i - 1)) bad++;
+                    }
+                    totalBytes += bytes;
+                    scans++;
+                }
+            });
+        }
+        long edits = 0;
+        mt19937 g(1);
+        while (chrono::steady_clock::now() < deadline) {
+            size_t i = g() % initial;
+            if (edits % 2) big -> addSong(title(initial + edits / 2, 0));
+            else big -> replaceSong(i, title(i, 1));
+            edits++;
+        }
+        for (auto& t : threads) t.join();
+        double secs = chrono::duration<double>(runFor).count();
+        cout << "MVCC       : " << (long)(scans / secs) << " scans/sec, " << (long)(edits / secs) << " edits/sec, "
+             << bad << " inconsistent reads, " << big -> freedChunks() << " chunks reclaimed" << endl;
+    }
+
+    // shared lock
+    {
+        LockedPlaylist big;
+        for (size_t i = 0; i < initial; i++) big.addSong(title(i, 0));
+
+        auto deadline = chrono::steady_clock::now() + runFor;     // readers stop on their own, so a starved writer gets through
+        atomic<long> scans{0}, bad{0};
+        atomic<size_t> totalBytes{0};
+        vector<thread> threads;
+        for (int r = 0; r < readers; r++) {
+            threads.emplace_back([&] {
+                while (chrono::steady_clock::now() < deadline) {
+                    size_t i = 0, bytes = 0;
+                    big.scan([&](const string& song) {
+                        bytes += song.size();
+                        if (i++ % 1024 == 0 && !consistent(song, i - 1)) bad++;
+                    });
+                    totalBytes += bytes;
+                    scans++;
+                }
+            });
+        }
+        long edits = 0;
+        mt19937 g(1);
+        while (chrono::steady_clock::now() < deadline) {
+            size_t i = g() % initial;
+            if (edits % 2) big.addSong(title(initial + edits / 2, 0));
+            else big.replaceSong(i, title(i, 1));
+            edits++;
+        }
+        for (auto& t : threads) t.join();
+        double secs = chrono::duration<double>(runFor).count();
+        cout << "shared lock: " << (long)(scans / secs) << " scans/sec, " << (long)(edits / secs) << " edits/sec, "
+             << bad << " inconsistent reads" << endl;
+    }
+
+    return 0;
+}
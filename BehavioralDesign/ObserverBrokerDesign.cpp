@@ -0,0 +1,528 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <pthread.h>
+using namespace std;
+
+/*
+    Why a topic broker?
+    In ObserverDesign.cpp every YoutubeChannel owns a
+    vector<shared_ptr<Subscriber>>. A subscriber following 1,000
+    channels sits in 1,000 vectors as 1,000 shared_ptr copies, and
+    nothing connects channels that live on the same machine.
+
+    TopicBroker owns all channels:
+    - subscribers are registered once and referred to by a 32-bit ID
+    - channel -> subscribers is a SubscriberSet: a sorted ID array
+      while small, a roaring-style bitmap (16-bit containers, array or
+      bitset each) once it is large
+    - channels are hashed onto shards, each shard is one thread pinned
+      to one core and is the only one touching its index, so there is
+      no locking on the index at all
+    - subscribe / unsubscribe / publish are messages posted to the
+      owning shard's lock-free mailbox
+*/
+
+class Subscriber {
+public:
+    virtual void notify(const string& video) = 0;
+    virtual ~Subscriber() {}
+};
+
+class EmailSubscriber: public Subscriber {
+private:
+    string email;
+public:
+    EmailSubscriber(const string& email) : email(email) {}
+    void notify(const string& video) override {
+        cout << "Email: New video out " + video << endl;
+    }
+};
+
+class PushSubscriber: public Subscriber {
+private:
+    string deviceToken;
+public:
+    PushSubscriber(const string& deviceToken) : deviceToken(deviceToken) {}
+    void notify(const string& video) override {
+        cout << "Push: New video out " + video << endl;
+    }
+};
+
+// --------- Compressed subscriber set ---------
+class SubscriberSet {
+private:
+    static constexpr size_t SMALL_LIMIT = 4096;     // sorted array up to here
+    static constexpr size_t ARRAY_LIMIT = 4096;     // per container, then a bitset
+
+    struct Container {
+        uint16_t key;                   // high 16 bits of the IDs inside
+        uint32_t cardinality = 0;
+        vector<uint16_t> array;         // sorted low bits, or
+        vector<uint64_t> bits;          // 65536-bit bitset
+
+        bool add(uint16_t low) {
+            if (!bits.empty()) {
+                uint64_t& word = bits[low >> 6];
+                uint64_t mask = 1ULL << (low & 63);
+                if (word & mask) return false;
+                word |= mask;
+                cardinality++;
+                return true;
+            }
+            auto it = lower_bound(array.begin(), array.end(), low);
+            if (it != array.end() && *it == low) return false;
+            array.insert(it, low);
+            cardinality++;
+            if (array.size() > ARRAY_LIMIT) {
+                bits.assign(1024, 0);
+                for (uint16_t v : array) bits[v >> 6] |= 1ULL << (v & 63);
+                vector<uint16_t>().swap(array);
+            }
+            return true;
+        }
+
+        bool remove(uint16_t low) {
+            if (!bits.empty()) {
+                uint64_t& word = bits[low >> 6];
+                uint64_t mask = 1ULL << (low & 63);
+                if (!(word & mask)) return false;
+                word &= ~mask;
+                cardinality--;
+                if (cardinality < ARRAY_LIMIT / 2) {    // hysteresis
+                    for (size_t w = 0; w < bits.size(); w++) {
+                        for (uint64_t b = bits[w]; b; b &= b - 1) array.push_back(uint16_t(w * 64 + __builtin_ctzll(b)));
+                    }
+                    vector<uint64_t>().swap(bits);
+                }
+                return true;
+            }
+            auto it = lower_bound(array.begin(), array.end(), low);
+            if (it == array.end() || *it != low) return false;
+            array.erase(it);
+            cardinality--;
+            return true;
+        }
+
+        template <typename Fn>
+        void forEach(Fn&& fn) const {
+            uint32_t high = uint32_t(key) << 16;
+            if (bits.empty()) {
+                for (uint16_t v : array) fn(high | v);
+                return;
+            }
+            for (size_t w = 0; w < bits.size(); w++) {
+                for (uint64_t b = bits[w]; b; b &= b - 1) fn(high | uint32_t(w * 64 + __builtin_ctzll(b)));
+            }
+        }
+
+        size_t bytes() const {
+            return sizeof(Container) + array.capacity() * sizeof(uint16_t) + bits.capacity() * sizeof(uint64_t);
+        }
+    };
+
+    vector<uint32_t> small;             // used until the set outgrows SMALL_LIMIT
+    vector<Container> containers;       // sorted by key
+    size_t count = 0;
+
+    Container& containerFor(uint16_t key) {
+        auto it = lower_bound(containers.begin(), containers.end(), key,
+                              [](const Container& c, uint16_t k) { return c.key < k; });
+        if (it == containers.end() || it -> key != key) {
+            it = containers.insert(it, Container());
+            it -> key = key;
+        }
+        return *it;
+    }
+
+    void promote() {
+        for (uint32_t id : small) containerFor(id >> 16).add(uint16_t(id));
+        vector<uint32_t>().swap(small);
+    }
+public:
+    bool add(uint32_t id) {
+        if (containers.empty()) {
+            auto it = lower_bound(small.begin(), small.end(), id);
+            if (it != small.end() && *it == id) return false;
+            small.insert(it, id);
+            count++;
+            if (small.size() > SMALL_LIMIT) promote();
+            return true;
+        }
+        if (!containerFor(id >> 16).add(uint16_t(id))) return false;
+        count++;
+        return true;
+    }
+
+    bool remove(uint32_t id) {
+        if (containers.empty()) {
+            auto it = lower_bound(small.begin(), small.end(), id);
+            if (it == small.end() || *it != id) return false;
+            small.erase(it);
+            count--;
+            return true;
+        }
+        auto it = lower_bound(containers.begin(), containers.end(), uint16_t(id >> 16),
+                              [](const Container& c, uint16_t k) { return c.key < k; });
+        if (it == containers.end() || it -> key != (id >> 16) || !it -> remove(uint16_t(id))) return false;
+        if (it -> cardinality == 0) containers.erase(it);
+        count--;
+        return true;
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (uint32_t id : small) fn(id);
+        for (auto& c : containers) c.forEach(fn);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    size_t bytes() const {
+        size_t total = sizeof(SubscriberSet) + small.capacity() * sizeof(uint32_t);
+        for (auto& c : containers) total += c.bytes();
+        return total;
+    }
+};
+
+// --------- Mailbox ---------
+// multi-producer single-consumer linked queue; producers never lock
+template <typename T>
+class Mailbox {
+private:
+    struct Node {
+        atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    alignas(64) atomic<Node*> head;
+    alignas(64) Node* tail;
+    atomic<bool> sleeping{false};
+    atomic<uint32_t> signal{0};
+public:
+    Mailbox() {
+        tail = new Node();
+        head.store(tail);
+    }
+
+    ~Mailbox() {
+        while (tail) {
+            Node* next = tail -> next.load();
+            delete tail;
+            tail = next;
+        }
+    }
+
+    void push(T value) {
+        Node* node = new Node();
+        node -> value = std::move(value);
+        Node* prev = head.exchange(node);
+        prev -> next.store(node);
+        if (sleeping.load()) {          // seq_cst, pairs with the check in wait()
+            signal.fetch_add(1);
+            signal.notify_one();
+        }
+    }
+
+    // consumer only
+    bool pop(T& out) {
+        Node* next = tail -> next.load(memory_order_acquire);
+        if (!next) return false;
+        out = std::move(next -> value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+    // consumer only: park until something arrives
+    void wait() {
+        uint32_t seen = signal.load();
+        sleeping.store(true);
+        if (!tail -> next.load()) signal.wait(seen);
+        sleeping.store(false);
+    }
+};
+
+// --------- Delivery ---------
+class DeliverySink {
+public:
+    // called on the shard thread with a batch of subscriber IDs
+    virtual void deliver(int shard, const uint32_t* ids, size_t count, const string& video) = 0;
+    virtual ~DeliverySink() {}
+};
+
+class DirectorySink : public DeliverySink {
+private:
+    vector<shared_ptr<Subscriber>> directory;   // sized once, IDs index into it
+    atomic<uint32_t> next{0};
+public:
+    DirectorySink(size_t capacity) : directory(capacity) {}
+
+    uint32_t add(shared_ptr<Subscriber> sub) {
+        uint32_t id = next.fetch_add(1);
+        if (id >= directory.size()) throw length_error("subscriber directory full");
+        directory[id] = std::move(sub);
+        return id;
+    }
+
+    void deliver(int, const uint32_t* ids, size_t count, const string& video) override {
+        for (size_t i = 0; i < count; i++) directory[ids[i]] -> notify(video);
+    }
+};
+
+class CountingSink : public DeliverySink {
+private:
+    struct alignas(64) Counter { long value = 0; };
+    vector<Counter> perShard;
+public:
+    CountingSink(int shards) : perShard(shards) {}
+
+    void deliver(int shard, const uint32_t*, size_t count, const string&) override {
+        perShard[shard].value += count;
+    }
+
+    // read only after TopicBroker::flush
+    long delivered() const {
+        long total = 0;
+        for (auto& c : perShard) total += c.value;
+        return total;
+    }
+};
+
+// --------- Broker ---------
+struct BrokerStats {
+    size_t channels = 0;
+    size_t subscriptions = 0;
+    size_t indexBytes = 0;
+};
+
+class TopicBroker {
+private:
+    struct Message {
+        enum Kind { SUBSCRIBE, UNSUBSCRIBE, PUBLISH, BARRIER, STOP } kind = BARRIER;
+        uint64_t channel = 0;
+        uint32_t subscriber = 0;
+        shared_ptr<const string> video;
+        promise<BrokerStats>* done = nullptr;
+    };
+
+    struct alignas(64) Shard {
+        Mailbox<Message> mailbox;
+        unordered_map<uint64_t, SubscriberSet> index;   // touched only by the shard thread
+        size_t subscriptions = 0;
+        thread worker;
+    };
+
+    DeliverySink& sink;
+    vector<unique_ptr<Shard>> shards;
+
+    static constexpr size_t DELIVERY_BATCH = 1024;
+
+    Shard& shardFor(uint64_t channel) {
+        uint64_t h = channel * 0x9E3779B97F4A7C15ULL;
+        return *shards[(h >> 32) % shards.size()];
+    }
+
+    BrokerStats stats(const Shard& s) const {
+        BrokerStats st;
+        st.channels = s.index.size();
+        st.subscriptions = s.subscriptions;
+        // bucket array plus one node per channel (key, set, next pointer, cached hash)
+        st.indexBytes = s.index.bucket_count() * sizeof(void*)
+                      + s.index.size() * (sizeof(pair<const uint64_t, SubscriberSet>) + 2 * sizeof(void*));
+        for (auto& [channel, set] : s.index) st.indexBytes += set.bytes() - sizeof(SubscriberSet);
+        return st;
+    }
+
+    void run(int id) {
+        Shard& s = *shards[id];
+        vector<uint32_t> batch;
+        batch.reserve(DELIVERY_BATCH);
+        Message m;
+        int idle = 0;
+        while (true) {
+            if (!s.mailbox.pop(m)) {
+                if (++idle < 64) this_thread::yield();
+                else s.mailbox.wait();
+                continue;
+            }
+            idle = 0;
+            switch (m.kind) {
+                case Message::SUBSCRIBE:
+                    if (s.index[m.channel].add(m.subscriber)) s.subscriptions++;
+                    break;
+                case Message::UNSUBSCRIBE: {
+                    auto it = s.index.find(m.channel);
+                    if (it != s.index.end() && it -> second.remove(m.subscriber)) {
+                        s.subscriptions--;
+                        if (it -> second.empty()) s.index.erase(it);
+                    }
+                    break;
+                }
+                case Message::PUBLISH: {
+                    auto it = s.index.find(m.channel);
+                    if (it == s.index.end()) break;
+                    it -> second.forEach([&](uint32_t sub) {
+                        batch.push_back(sub);
+                        if (batch.size() == DELIVERY_BATCH) {
+                            sink.deliver(id, batch.data(), batch.size(), *m.video);
+                            batch.clear();
+                        }
+                    });
+                    if (!batch.empty()) sink.deliver(id, batch.data(), batch.size(), *m.video);
+                    batch.clear();
+                    break;
+                }
+                case Message::BARRIER:
+                    m.done -> set_value(stats(s));
+                    break;
+                case Message::STOP:
+                    return;
+            }
+            m.video.reset();
+        }
+    }
+
+    static void pin(thread& t, int core) {
+        int cores = (int)thread::hardware_concurrency();
+        if (cores <= 0) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core % cores, &set);
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);   // best effort
+    }
+
+    void post(Shard& s, Message m) { s.mailbox.push(std::move(m)); }
+public:
+    TopicBroker(DeliverySink& sink, int shardCount) : sink(sink) {
+        for (int i = 0; i < shardCount; i++) shards.push_back(make_unique<Shard>());
+        for (int i = 0; i < shardCount; i++) {
+            shards[i] -> worker = thread([this, i] { run(i); });
+            pin(shards[i] -> worker, i);
+        }
+    }
+
+    ~TopicBroker() {
+        for (auto& s : shards) {
+            Message m;
+            m.kind = Message::STOP;
+            post(*s, std::move(m));
+        }
+        for (auto& s : shards) s -> worker.join();
+    }
+
+    void subscribe(uint64_t channel, uint32_t subscriber) {
+        Message m;
+        m.kind = Message::SUBSCRIBE;
+        m.channel = channel;
+        m.subscriber = subscriber;
+        post(shardFor(channel), std::move(m));
+    }
+
+    void unsubscribe(uint64_t channel, uint32_t subscriber) {
+        Message m;
+        m.kind = Message::UNSUBSCRIBE;
+        m.channel = channel;
+        m.subscriber = subscriber;
+        post(shardFor(channel), std::move(m));
+    }
+
+    void publish(uint64_t channel, const string& video) {
+        Message m;
+        m.kind = Message::PUBLISH;
+        m.channel = channel;
+        m.video = make_shared<const string>(video);
+        post(shardFor(channel), std::move(m));
+    }
+
+    // waits until every shard processed everything posted before, and sums their stats
+    BrokerStats flush() {
+        vector<promise<BrokerStats>> done(shards.size());
+        for (size_t i = 0; i < shards.size(); i++) {
+            Message m;
+            m.kind = Message::BARRIER;
+            m.done = &done[i];
+            post(*shards[i], std::move(m));
+        }
+        BrokerStats total;
+        for (auto& p : done) {
+            BrokerStats st = p.get_future().get();
+            total.channels += st.channels;
+            total.subscriptions += st.subscriptions;
+            total.indexBytes += st.indexBytes;
+        }
+        return total;
+    }
+
+    int shardCount() const { return (int)shards.size(); }
+};
+
+int main() {
+    {
+        DirectorySink directory(16);
+        TopicBroker broker(directory, 2);
+
+        uint32_t sub1 = directory.add(make_shared<EmailSubscriber>("example@example.com"));
+        uint32_t sub2 = directory.add(make_shared<PushSubscriber>("device_token_123"));
+
+        const uint64_t cypherJet = 11, dbDaily = 12;
+        broker.subscribe(cypherJet, sub1);
+        broker.subscribe(cypherJet, sub2);
+        broker.subscribe(dbDaily, sub1);
+
+        broker.publish(cypherJet, "LLM-DB-Search");
+        broker.flush();
+        broker.publish(dbDaily, "B-Tree-vs-LSM");
+        broker.flush();
+
+        broker.unsubscribe(cypherJet, sub1);
+        broker.publish(cypherJet, "Vector-Index-Deep-Dive");
+        broker.flush();
+    }
+
+    const int shardCount = max(2, (int)thread::hardware_concurrency());
+    const uint64_t channels = 1'000'000;
+    const uint32_t subscribers = 2'000'000;
+    const size_t subscriptions = 12'000'000;
+    cout << "\n--- " << channels << " channels, " << subscribers << " subscribers, "
+         << subscriptions << " subscriptions, " << shardCount << " shards ---" << endl;
+
+    CountingSink counter(shardCount);
+    TopicBroker broker(counter, shardCount);
+
+    // channel popularity is roughly Zipf: rank = N^u
+    mt19937_64 g(21);
+    uniform_real_distribution<double> u(0, 1);
+    auto zipfChannel = [&] { return (uint64_t)pow((double)channels, u(g)) - 1; };
+
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < subscriptions; i++) broker.subscribe(zipfChannel(), uint32_t(g() % subscribers));
+    BrokerStats st = broker.flush();
+    double subSecs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    cout << "subscribe: " << (long)(subscriptions / subSecs / 1e3) << " k/sec" << endl;
+    cout << st.channels << " channels, " << st.subscriptions << " distinct subscriptions, "
+         << (double)st.indexBytes / st.subscriptions << " bytes/subscription "
+         << "(vector<shared_ptr> per channel: " << (16.0 * st.subscriptions + 24.0 * st.channels) / st.subscriptions << ")" << endl;
+
+    const long publishes = 20'000;
+    t0 = chrono::steady_clock::now();
+    for (long i = 0; i < publishes; i++) broker.publish(zipfChannel(), "Clip");
+    broker.flush();
+    double pubSecs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    cout << "publish: " << (long)(publishes / pubSecs / 1e3) << " k publishes/sec, "
+         << (long)(counter.delivered() / pubSecs / 1e6) << " M deliveries/sec" << endl;
+
+    return 0;
+}
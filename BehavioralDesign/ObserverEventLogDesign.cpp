@@ -0,0 +1,502 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+/*
+    Why a durable event log?
+    In ObserverDesign.cpp uploadContent only calls notify on whoever
+    is subscribed right now. A subscriber that is offline misses the
+    upload for good, nothing is written anywhere.
+
+    Every channel gets an append-only ChannelEventLog:
+    - a preallocated, memory-mapped file, an append is a memcpy
+    - appends are made durable by group commit: a flusher thread
+      msyncs everything appended since the last sync in one go and
+      wakes all appenders it covered, so N concurrent uploads cost
+      one sync instead of N
+    - readers only ever see the durable prefix
+    Every subscriber keeps a cursor, the log offset right after the
+    last event it has seen, in a small memory-mapped CursorTable.
+    The table also persists how many slots were handed out, so a new
+    subscriber after a restart never gets the slot of one that is not
+    restored yet; it grows (ftruncate + mremap) when it runs out.
+    An online subscriber is notified live and its cursor moves along;
+    an offline one comes back only through catchUp, which reads the
+    contiguous range from its cursor to the end of the log, a
+    sequential scan of the mapping, instead of draining a
+    per-subscriber retry queue.
+
+    Record: [ length u32 | checksum u32 | sequence u64 | payload ]
+    Reopening scans records from the start and stops at the first
+    one whose checksum or sequence is wrong (a torn tail).
+    Delivery is at-least-once: a cursor that was not yet written back
+    replays a few events after a crash.
+*/
+
+class Subscriber {
+public:
+    virtual void notify(const string& video) = 0;
+    virtual ~Subscriber() {}
+};
+
+class EmailSubscriber: public Subscriber {
+private:
+    string email;
+public:
+    EmailSubscriber(const string& email) : email(email) {}
+    void notify(const string& video) override {
+        cout << "Email: New video out " + video << endl;
+    }
+};
+
+class PushSubscriber: public Subscriber {
+private:
+    string deviceToken;
+public:
+    PushSubscriber(const string& deviceToken) : deviceToken(deviceToken) {}
+    void notify(const string& video) override {
+        cout << "Push: New video out " + video << endl;
+    }
+};
+
+// --------- Event log ---------
+class ChannelEventLog {
+private:
+    struct RecordHeader {
+        uint32_t length;
+        uint32_t checksum;
+        uint64_t sequence;
+    };
+
+    int fd = -1;
+    char* map = nullptr;
+    size_t capacity;
+    bool groupCommit;
+
+    mutex lock;
+    condition_variable pendingWork, durableMoved;
+    uint64_t end = 0;                   // bytes appended, guarded by lock
+    uint64_t nextSequence = 0;
+    atomic<uint64_t> durable{0};        // bytes known to be on disk
+    bool stopping = false;
+    long syncCount = 0;
+    thread flusher;
+
+    static uint32_t checksum(uint64_t sequence, string_view payload) {
+        uint32_t h = 2166136261u;
+        for (int i = 0; i < 8; i++) h = (h ^ (uint8_t)(sequence >> (8 * i))) * 16777619u;
+        for (char c : payload) h = (h ^ (uint8_t)c) * 16777619u;
+        return h;
+    }
+
+    // msync wants a page-aligned start
+    void sync(uint64_t from, uint64_t to) {
+        static const uint64_t page = sysconf(_SC_PAGESIZE);
+        uint64_t begin = from & ~(page - 1);
+        if (to > begin && msync(map + begin, to - begin, MS_SYNC) < 0) {
+            throw runtime_error("msync failed: " + string(strerror(errno)));
+        }
+    }
+
+    void flushLoop() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            pendingWork.wait(guard, [&] { return end > durable.load() || stopping; });
+            if (end == durable.load() && stopping) return;
+            uint64_t from = durable.load(), to = end;
+            guard.unlock();
+            sync(from, to);             // everything appended meanwhile waits for the next round
+            guard.lock();
+            durable.store(to, memory_order_release);
+            syncCount++;
+            durableMoved.notify_all();
+        }
+    }
+
+    // constructor failures: release the descriptor before throwing
+    [[noreturn]] void fail(const string& what) {
+        string reason = strerror(errno);
+        close(fd);
+        fd = -1;
+        throw runtime_error(what + " failed: " + reason);
+    }
+
+    // finds the end of the valid prefix after a restart
+    void recover() {
+        uint64_t offset = 0;
+        while (offset + sizeof(RecordHeader) <= capacity) {
+            RecordHeader h;
+            memcpy(&h, map + offset, sizeof(h));
+            if (h.length == 0 || offset + sizeof(h) + h.length > capacity) break;
+            if (h.sequence != nextSequence) break;
+            if (checksum(h.sequence, string_view(map + offset + sizeof(h), h.length)) != h.checksum) break;
+            offset += sizeof(h) + h.length;
+            nextSequence++;
+        }
+        end = offset;
+        durable.store(offset);
+    }
+
+public:
+    ChannelEventLog(const string& path, size_t capacity = 256 << 20, bool groupCommit = true)
+        : capacity(capacity), groupCommit(groupCommit) {
+        fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) throw runtime_error("Cannot open " + path + ": " + strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) < 0) fail("fstat " + path);
+        if ((size_t)st.st_size < capacity && ftruncate(fd, capacity) < 0) fail("ftruncate " + path);
+        void* p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) fail("mmap " + path);
+        map = static_cast<char*>(p);
+        recover();
+        if (groupCommit) flusher = thread([this] { flushLoop(); });
+    }
+
+    ~ChannelEventLog() {
+        if (flusher.joinable()) {
+            {
+                lock_guard<mutex> guard(lock);
+                stopping = true;
+            }
+            pendingWork.notify_one();
+            flusher.join();
+        }
+        if (map) munmap(map, capacity);
+        if (fd >= 0) close(fd);
+    }
+
+    ChannelEventLog(const ChannelEventLog&) = delete;
+    ChannelEventLog& operator=(const ChannelEventLog&) = delete;
+
+    // returns the offset right after the new record; not durable yet
+    uint64_t appendAsync(string_view payload) {
+        lock_guard<mutex> guard(lock);
+        size_t need = sizeof(RecordHeader) + payload.size();
+        if (payload.empty()) throw invalid_argument("empty event");
+        if (end + need > capacity) throw length_error("event log full");
+
+        RecordHeader h{(uint32_t)payload.size(), checksum(nextSequence, payload), nextSequence};
+        memcpy(map + end, &h, sizeof(h));
+        memcpy(map + end + sizeof(h), payload.data(), payload.size());
+        end += need;
+        nextSequence++;
+        if (groupCommit) pendingWork.notify_one();
+        return end;
+    }
+
+    void waitDurable(uint64_t offset) {
+        if (durable.load(memory_order_acquire) >= offset) return;
+        if (!groupCommit) {
+            // one sync per caller, the baseline group commit is measured against
+            uint64_t from = durable.load();
+            sync(from, offset);
+            lock_guard<mutex> guard(lock);
+            syncCount++;
+            if (durable.load() < offset) durable.store(offset, memory_order_release);
+            return;
+        }
+        unique_lock<mutex> guard(lock);
+        durableMoved.wait(guard, [&] { return durable.load() >= offset; });
+    }
+
+    // returns once the event is on disk
+    uint64_t append(string_view payload) {
+        uint64_t offset = appendAsync(payload);
+        waitDurable(offset);
+        return offset;
+    }
+
+    // streams durable events from `cursor`, fn(payload, cursor after it); returns the new cursor
+    template <typename Fn>
+    uint64_t readFrom(uint64_t cursor, Fn&& fn) const {
+        uint64_t limit = durable.load(memory_order_acquire);
+        while (cursor < limit) {
+            RecordHeader h;
+            memcpy(&h, map + cursor, sizeof(h));
+            cursor += sizeof(h) + h.length;
+            fn(string_view(map + cursor - h.length, h.length), cursor);
+        }
+        return cursor;
+    }
+
+    uint64_t durableEnd() const { return durable.load(memory_order_acquire); }
+    uint64_t events() {
+        lock_guard<mutex> guard(lock);
+        return nextSequence;
+    }
+    long syncs() {
+        lock_guard<mutex> guard(lock);
+        return syncCount;
+    }
+
+    // hint for catch-up scans over a long range
+    void adviseSequential() const { madvise(map, capacity, MADV_SEQUENTIAL); }
+};
+
+// --------- Cursors ---------
+// [ slots handed out u64 | cursor u64 per slot ], written back by the kernel or on flush()
+class CursorTable {
+private:
+    int fd = -1;
+    uint64_t* table = nullptr;
+    size_t count = 0;                   // slots the mapping has room for
+
+    static size_t bytesFor(size_t slots) { return (slots + 1) * sizeof(uint64_t); }
+
+    [[noreturn]] void fail(const string& what) {
+        string reason = strerror(errno);
+        if (table) munmap(table, bytesFor(count));
+        table = nullptr;
+        close(fd);
+        fd = -1;
+        throw runtime_error(what + " failed: " + reason);
+    }
+
+    // doubles the file and the mapping, the mapping may move
+    void grow() {
+        size_t next = count * 2;
+        if (ftruncate(fd, bytesFor(next)) < 0) throw runtime_error("ftruncate failed: " + string(strerror(errno)));
+        void* p = mremap(table, bytesFor(count), bytesFor(next), MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) throw runtime_error("mremap failed: " + string(strerror(errno)));
+        table = static_cast<uint64_t*>(p);
+        count = next;
+    }
+
+    void check(size_t slot) const {
+        if (slot >= table[0]) throw out_of_range("no cursor slot " + to_string(slot));
+    }
+public:
+    CursorTable(const string& path, size_t initialSlots) {
+        fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) throw runtime_error("Cannot open " + path + ": " + strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) < 0) fail("fstat " + path);
+        count = max<size_t>(1, initialSlots);
+        if ((size_t)st.st_size > bytesFor(count)) count = st.st_size / sizeof(uint64_t) - 1;
+        if ((size_t)st.st_size < bytesFor(count) && ftruncate(fd, bytesFor(count)) < 0) fail("ftruncate " + path);
+        void* p = mmap(nullptr, bytesFor(count), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) fail("mmap " + path);
+        table = static_cast<uint64_t*>(p);
+        if (table[0] > count) {
+            errno = EINVAL;
+            fail("slot count in " + path);
+        }
+    }
+
+    ~CursorTable() {
+        if (table) munmap(table, bytesFor(count));
+        if (fd >= 0) close(fd);
+    }
+
+    CursorTable(const CursorTable&) = delete;
+    CursorTable& operator=(const CursorTable&) = delete;
+
+    // a slot no one has had before, persisted or not
+    size_t allocate(uint64_t cursor) {
+        if (table[0] == count) grow();
+        size_t slot = table[0];
+        table[1 + slot] = cursor;
+        table[0] = slot + 1;
+        return slot;
+    }
+
+    size_t allocated() const { return table[0]; }
+
+    uint64_t get(size_t slot) const {
+        check(slot);
+        return table[1 + slot];
+    }
+    void set(size_t slot, uint64_t cursor) {
+        check(slot);
+        table[1 + slot] = cursor;
+    }
+    void flush() { msync(table, bytesFor(count), MS_SYNC); }
+};
+
+// --------- Channel ---------
+class YoutubeChannel {
+private:
+    string uid;
+    string name;
+    ChannelEventLog log;
+    CursorTable cursors;
+    vector<shared_ptr<Subscriber>> Subscribers;     // index == cursor slot, null until restored
+    vector<bool> online;
+
+    void place(size_t slot, shared_ptr<Subscriber> sub) {
+        if (Subscribers.size() <= slot) {
+            Subscribers.resize(slot + 1);
+            online.resize(slot + 1, false);
+        }
+        Subscribers[slot] = std::move(sub);
+    }
+
+    void checkSlot(size_t slot) const {
+        if (slot >= Subscribers.size() || !Subscribers[slot]) throw out_of_range("no subscriber in slot " + to_string(slot));
+    }
+public:
+    YoutubeChannel(const string& uid, const string& name, const string& dir, size_t cursorSlots = 1024)
+        : uid(uid), name(name), log(dir + "/channel-" + uid + ".log"),
+          cursors(dir + "/channel-" + uid + ".cursors", cursorSlots) {}
+
+    // new subscribers start at the current end, they do not get the history
+    size_t addSubscriber(shared_ptr<Subscriber> sub) {
+        size_t slot = cursors.allocate(log.durableEnd());     // after every slot ever handed out
+        place(slot, std::move(sub));
+        online[slot] = true;
+        return slot;
+    }
+
+    // after a restart: a known subscriber takes its slot back and keeps its cursor;
+    // it stays offline until catchUp
+    void restoreSubscriber(size_t slot, shared_ptr<Subscriber> sub) {
+        if (slot >= cursors.allocated()) throw out_of_range("slot " + to_string(slot) + " was never handed out");
+        if (slot < Subscribers.size() && Subscribers[slot]) throw invalid_argument("slot " + to_string(slot) + " is taken");
+        place(slot, std::move(sub));
+        online[slot] = false;
+    }
+
+    // going back online is catchUp, so nothing missed meanwhile is skipped
+    void setOffline(size_t slot) {
+        checkSlot(slot);
+        online[slot] = false;
+    }
+
+    // the upload is durable before anyone is told about it
+    void uploadContent(const string& video) {
+        uint64_t cursor = log.append(video);
+        for (size_t i = 0; i < Subscribers.size(); i++) {
+            if (!online[i]) continue;
+            Subscribers[i] -> notify(video);
+            cursors.set(i, cursor);
+        }
+    }
+
+    // replays everything after the subscriber's cursor; returns the number of events
+    size_t catchUp(size_t slot) {
+        checkSlot(slot);
+        size_t replayed = 0;
+        uint64_t cursor = log.readFrom(cursors.get(slot), [&](string_view video, uint64_t next) {
+            Subscribers[slot] -> notify(string(video));
+            cursors.set(slot, next);
+            replayed++;
+        });
+        cursors.set(slot, cursor);
+        online[slot] = true;
+        return replayed;
+    }
+};
+
+// --------- Benchmark ---------
+void appendBenchmark(const string& path, bool groupCommit, int threads, int perThread) {
+    unlink(path.c_str());
+    ChannelEventLog log(path, 64 << 20, groupCommit);
+    string payload(100, 'x');
+
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> writers;
+    for (int t = 0; t < threads; t++) {
+        writers.emplace_back([&] {
+            for (int i = 0; i < perThread; i++) log.append(payload);
+        });
+    }
+    for (auto& w : writers) w.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    long total = (long)threads * perThread;
+    cout << (groupCommit ? "group commit  " : "sync per event") << ": " << (long)(total / secs)
+         << " durable appends/sec, " << log.syncs() << " syncs for " << total << " appends" << endl;
+    unlink(path.c_str());
+}
+
+int main() {
+    char dir[] = "/tmp/channellogXXXXXX";
+    if (!mkdtemp(dir)) throw runtime_error("mkdtemp failed");
+    string logDir = dir;
+
+    {
+        YoutubeChannel yt("11", "CypherJet", logDir);
+
+        auto sub1 = make_shared<EmailSubscriber>("example@example.com");
+        auto sub2 = make_shared<PushSubscriber>("device_token_123");
+
+        size_t s1 = yt.addSubscriber(sub1);
+        size_t s2 = yt.addSubscriber(sub2);
+
+        yt.uploadContent("LLM-DB-Search");
+
+        yt.setOffline(s2);              // the phone goes offline
+        yt.uploadContent("Vector-Index-Deep-Dive");
+        yt.uploadContent("B-Tree-vs-LSM");
+
+        cout << "push subscriber back online, catching up:" << endl;
+        cout << yt.catchUp(s2) << " events replayed" << endl;
+
+        yt.setOffline(s1);              // and then the email subscriber misses one
+        yt.uploadContent("Raft-In-Practice");
+    }
+    {
+        // reopening the channel keeps the log and the cursors
+        YoutubeChannel yt("11", "CypherJet", logDir);
+        size_t newcomer = yt.addSubscriber(make_shared<PushSubscriber>("device_token_456"));
+        cout << "new subscriber before the restore gets slot " << newcomer << endl;
+        yt.restoreSubscriber(0, make_shared<EmailSubscriber>("example@example.com"));
+        cout << "after restart, email subscriber catching up:" << endl;
+        cout << yt.catchUp(0) << " events replayed" << endl;
+    }
+    {
+        // the cursor table grows past the size it was created with
+        YoutubeChannel yt("14", "Growing", logDir, 4);
+        for (int i = 0; i < 2000; i++) yt.addSubscriber(make_shared<PushSubscriber>("tok" + to_string(i)));
+        cout << "2000 subscribers on a table sized for 4, last slot catches up "
+             << yt.catchUp(1999) << " events" << endl;
+    }
+    unlink((logDir + "/channel-14.log").c_str());
+    unlink((logDir + "/channel-14.cursors").c_str());
+    unlink((logDir + "/channel-11.log").c_str());
+    unlink((logDir + "/channel-11.cursors").c_str());
+
+    cout << "\n--- durable appends, 8 uploader threads, 100 byte events ---" << endl;
+    appendBenchmark(logDir + "/bench.log", false, 8, 250);
+    appendBenchmark(logDir + "/bench.log", true, 8, 2500);
+
+    cout << "\n--- catch-up of a subscriber that missed 1M events ---" << endl;
+    {
+        string path = logDir + "/catchup.log";
+        ChannelEventLog log(path, 512 << 20);
+        string payload(200, 'v');
+        uint64_t last = 0;
+        for (int i = 0; i < 1'000'000; i++) last = log.appendAsync(payload);
+        log.waitDurable(last);
+
+        log.adviseSequential();
+        size_t events = 0, bytes = 0;
+        auto t0 = chrono::steady_clock::now();
+        uint64_t cursor = log.readFrom(0, [&](string_view video, uint64_t) {
+            events++;
+            bytes += video.size();
+        });
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        cout << events << " events, " << (cursor >> 20) << " MB of log read in " << (long)(secs * 1000) << " ms, "
+             << (cursor / secs / 1e9) << " GB/s" << endl;
+        unlink(path.c_str());
+    }
+
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,392 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+using namespace std;
+
+/*
+    Why an asynchronous fan-out?
+    In ObserverDesign.cpp uploadContent calls notify on every
+    subscriber, one by one, on the uploader's thread. With millions
+    of subscribers and slow Email / Push delivery one upload blocks
+    for minutes.
+
+    Here uploadContent only enqueues one UploadEvent and returns.
+    - the channel keeps subscribers grouped by delivery type in a
+      roster; an upload shares the current roster with the event, and
+      a subscribe / unsubscribe copies it only while a queued event
+      still reads it (copy-on-write), so queued events never see a
+      roster change and a subscribe between uploads stays O(1)
+    - a dispatcher thread cuts the snapshot into batches, each batch
+      holds subscribers of one type only
+    - worker threads hand whole batches to the DeliverySink, which
+      stands in for a bulk Email / Push provider API; a batch whose
+      bulk call throws is counted as failed, the worker carries on
+    - the event queue and the batch queue are bounded; when workers
+      fall behind the dispatcher blocks, and then uploadContent blocks
+      (backpressure instead of unbounded memory)
+*/
+
+enum class ChannelType { EMAIL, PUSH, COUNT };
+
+class Subscriber {
+public:
+    virtual void notify(const string& video) = 0;
+    virtual ChannelType channel() const = 0;
+    virtual const string& address() const = 0;
+    virtual ~Subscriber() {}
+};
+
+class EmailSubscriber: public Subscriber {
+private:
+    string email;
+public:
+    EmailSubscriber(const string& email) : email(email) {}
+    void notify(const string& video) override {
+        cout << "Email: New video out " + video << endl;
+    }
+    ChannelType channel() const override { return ChannelType::EMAIL; }
+    const string& address() const override { return email; }
+};
+
+class PushSubscriber: public Subscriber {
+private:
+    string deviceToken;
+public:
+    PushSubscriber(const string& deviceToken) : deviceToken(deviceToken) {}
+    void notify(const string& video) override {
+        cout << "Push: New video out " + video << endl;
+    }
+    ChannelType channel() const override { return ChannelType::PUSH; }
+    const string& address() const override { return deviceToken; }
+};
+
+// --------- Delivery ---------
+class DeliverySink {
+public:
+    // one bulk call for a batch of subscribers of the same type
+    virtual void deliverBatch(ChannelType type, const shared_ptr<Subscriber>* subscribers, size_t count, const string& video) = 0;
+    virtual ~DeliverySink() {}
+};
+
+class ConsoleSink : public DeliverySink {
+private:
+    mutex lock;
+public:
+    void deliverBatch(ChannelType, const shared_ptr<Subscriber>* subscribers, size_t count, const string& video) override {
+        lock_guard<mutex> guard(lock);
+        for (size_t i = 0; i < count; i++) subscribers[i] -> notify(video);
+    }
+};
+
+// a bulk provider outage, every call throws
+class FailingSink : public DeliverySink {
+public:
+    void deliverBatch(ChannelType, const shared_ptr<Subscriber>*, size_t, const string&) override {
+        throw runtime_error("provider unavailable");
+    }
+};
+
+// counts deliveries, optionally sleeping per bulk call like a provider round trip
+class StubSink : public DeliverySink {
+private:
+    chrono::microseconds perBatch;
+public:
+    atomic<long> delivered[(int)ChannelType::COUNT] = {0, 0};
+    atomic<long> batches{0};
+
+    StubSink(chrono::microseconds perBatch = chrono::microseconds(0)) : perBatch(perBatch) {}
+
+    void deliverBatch(ChannelType type, const shared_ptr<Subscriber>*, size_t count, const string&) override {
+        if (perBatch.count() > 0) this_thread::sleep_for(perBatch);
+        delivered[(int)type].fetch_add(count, memory_order_relaxed);
+        batches.fetch_add(1, memory_order_relaxed);
+    }
+};
+
+// --------- Bounded queue ---------
+template <typename T>
+class BoundedQueue {
+private:
+    deque<T> items;
+    size_t capacity;
+    bool closed = false;
+    mutex lock;
+    condition_variable notFull, notEmpty;
+public:
+    BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    // blocks while full, this is the backpressure
+    void push(T item) {
+        unique_lock<mutex> guard(lock);
+        notFull.wait(guard, [&] { return items.size() < capacity || closed; });
+        if (closed) throw runtime_error("push on closed queue");
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    // empty optional once the queue is closed and drained
+    optional<T> pop() {
+        unique_lock<mutex> guard(lock);
+        notEmpty.wait(guard, [&] { return !items.empty() || closed; });
+        if (items.empty()) return nullopt;
+        T item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return item;
+    }
+
+    void close() {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+};
+
+// --------- Pipeline ---------
+struct Roster {
+    vector<shared_ptr<Subscriber>> byType[(int)ChannelType::COUNT];
+};
+
+struct UploadEvent {
+    string video;
+    shared_ptr<const Roster> roster;
+};
+
+class FanoutPipeline {
+private:
+    struct Batch {
+        shared_ptr<const UploadEvent> event;
+        ChannelType type;
+        size_t begin, end;
+    };
+
+    DeliverySink& sink;
+    size_t batchSize;
+    BoundedQueue<shared_ptr<const UploadEvent>> events;
+    BoundedQueue<Batch> batches;
+    thread dispatcher;
+    vector<thread> workers;
+
+    mutex idleLock;
+    condition_variable idle;
+    long inFlight = 0;      // published events plus queued batches not yet delivered
+    atomic<long> failed{0};
+
+    void finished(long n) {
+        lock_guard<mutex> guard(idleLock);
+        inFlight -= n;
+        if (inFlight == 0) idle.notify_all();
+    }
+
+    void dispatch() {
+        while (auto event = events.pop()) {
+            long count = 0;
+            for (int t = 0; t < (int)ChannelType::COUNT; t++) {
+                size_t n = (*event) -> roster -> byType[t].size();
+                count += (n + batchSize - 1) / batchSize;
+            }
+            {
+                lock_guard<mutex> guard(idleLock);
+                inFlight += count;
+            }
+            for (int t = 0; t < (int)ChannelType::COUNT; t++) {
+                size_t n = (*event) -> roster -> byType[t].size();
+                for (size_t begin = 0; begin < n; begin += batchSize) {
+                    batches.push(Batch{*event, ChannelType(t), begin, min(n, begin + batchSize)});
+                }
+            }
+            finished(1);
+        }
+        batches.close();
+    }
+
+    void work() {
+        while (auto batch = batches.pop()) {
+            auto& list = batch -> event -> roster -> byType[(int)batch -> type];
+            try {
+                sink.deliverBatch(batch -> type, list.data() + batch -> begin, batch -> end - batch -> begin, batch -> event -> video);
+            }
+            catch (...) {
+                failed.fetch_add(1, memory_order_relaxed);     // a real pipeline would retry or dead-letter it
+            }
+            finished(1);
+        }
+    }
+
+public:
+    FanoutPipeline(DeliverySink& sink, size_t workerCount = 4, size_t batchSize = 1000,
+                   size_t eventCapacity = 64, size_t batchCapacity = 256)
+        : sink(sink), batchSize(batchSize), events(eventCapacity), batches(batchCapacity) {
+        dispatcher = thread([this] { dispatch(); });
+        for (size_t i = 0; i < workerCount; i++) workers.emplace_back([this] { work(); });
+    }
+
+    ~FanoutPipeline() {
+        events.close();
+        dispatcher.join();
+        for (auto& w : workers) w.join();
+    }
+
+    void publish(shared_ptr<const UploadEvent> event) {
+        {
+            lock_guard<mutex> guard(idleLock);
+            inFlight++;
+        }
+        events.push(std::move(event));
+    }
+
+    // waits until every published event reached the sink
+    void drain() {
+        unique_lock<mutex> guard(idleLock);
+        idle.wait(guard, [&] { return inFlight == 0; });
+    }
+
+    long failedBatches() const { return failed.load(); }
+};
+
+// --------- Channel ---------
+class YoutubeChannel {
+private:
+    string uid;
+    string name;
+    // who still reads the current roster; outlives the channel inside queued events
+    struct Sharing {
+        mutex writer;               // roster changes and uploads serialize here
+        uint64_t generation = 0;    // bumped whenever the roster is replaced by a copy
+        long readers = 0;           // queued events holding the current generation
+    };
+
+    shared_ptr<Roster> subscribers = make_shared<Roster>();     // guarded by sharing -> writer
+    shared_ptr<Sharing> sharing = make_shared<Sharing>();
+    FanoutPipeline& pipeline;
+
+    // changes in place, copies only while a queued event still reads the roster
+    template <typename Change>
+    void updateRoster(Change change) {
+        lock_guard<mutex> guard(sharing -> writer);
+        if (sharing -> readers > 0) {
+            subscribers = make_shared<Roster>(*subscribers);
+            sharing -> generation++;
+            sharing -> readers = 0;
+        }
+        change(*subscribers);
+    }
+
+    // the event's handle, releasing it drops one reader of its generation
+    shared_ptr<const Roster> share() {
+        lock_guard<mutex> guard(sharing -> writer);
+        sharing -> readers++;
+        return shared_ptr<const Roster>(subscribers.get(),
+            [owner = subscribers, state = sharing, generation = sharing -> generation](const Roster*) {
+                lock_guard<mutex> guard(state -> writer);
+                if (state -> generation == generation) state -> readers--;
+            });
+    }
+public:
+    YoutubeChannel(const string& uid, const string& name, FanoutPipeline& pipeline)
+        : uid(uid), name(name), pipeline(pipeline) {}
+
+    void addSubscriber(shared_ptr<Subscriber> sub) {
+        updateRoster([&](Roster& roster) { roster.byType[(int)sub -> channel()].push_back(std::move(sub)); });
+    }
+
+    // at most one roster copy for the whole import
+    void addSubscribers(vector<shared_ptr<Subscriber>> subs) {
+        updateRoster([&](Roster& roster) {
+            for (auto& sub : subs) roster.byType[(int)sub -> channel()].push_back(std::move(sub));
+        });
+    }
+
+    void removeSubscriber(const shared_ptr<Subscriber>& sub) {
+        updateRoster([&](Roster& roster) {
+            auto& list = roster.byType[(int)sub -> channel()];
+            list.erase(remove(list.begin(), list.end(), sub), list.end());
+        });
+    }
+
+    // returns as soon as the event is queued
+    void uploadContent(const string& video) {
+        pipeline.publish(make_shared<const UploadEvent>(UploadEvent{name + ": " + video, share()}));
+    }
+};
+
+int main() {
+    {
+        ConsoleSink console;
+        FanoutPipeline pipeline(console, 2, 2);
+        YoutubeChannel yt("11", "CypherJet", pipeline);
+
+        auto sub1 = make_shared<EmailSubscriber>("example@example.com");
+        auto sub2 = make_shared<PushSubscriber>("device_token_123");
+
+        yt.addSubscriber(sub1);
+        yt.addSubscriber(sub2);
+
+        yt.uploadContent("LLM-DB-Search");
+        pipeline.drain();
+
+        yt.removeSubscriber(sub1);
+        yt.removeSubscriber(sub2);
+    }
+    {
+        FailingSink failing;
+        FanoutPipeline pipeline(failing, 2, 2);
+        YoutubeChannel yt("13", "Outage", pipeline);
+        yt.addSubscribers({make_shared<EmailSubscriber>("a@x.io"), make_shared<EmailSubscriber>("b@x.io"),
+                           make_shared<PushSubscriber>("tok")});
+        yt.uploadContent("Still-Here");
+        pipeline.drain();
+        cout << "failed batches during a provider outage: " << pipeline.failedBatches() << endl;
+    }
+
+    const size_t subscribers = 10'000'000;
+    cout << "\n--- " << subscribers << " subscribers, stub sink with 20us per bulk call ---" << endl;
+
+    StubSink stub(chrono::microseconds(20));
+    FanoutPipeline pipeline(stub, 8, 5000);
+    YoutubeChannel yt("12", "BigChannel", pipeline);
+    auto s0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < subscribers; i++) {
+        if (i % 2) yt.addSubscriber(make_shared<EmailSubscriber>("u" + to_string(i) + "@x.io"));
+        else yt.addSubscriber(make_shared<PushSubscriber>("tok" + to_string(i)));
+    }
+    double subscribeMs = chrono::duration<double, milli>(chrono::steady_clock::now() - s0).count();
+
+    auto t0 = chrono::steady_clock::now();
+    yt.uploadContent("Launch");
+    double enqueueMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    // while Launch is delivering, the first subscribe copies the roster, the rest do not
+    const int late = 1000;
+    auto l0 = chrono::steady_clock::now();
+    yt.addSubscriber(make_shared<EmailSubscriber>("late0@x.io"));
+    double firstLateMs = chrono::duration<double, milli>(chrono::steady_clock::now() - l0).count();
+    auto l1 = chrono::steady_clock::now();
+    for (int i = 1; i < late; i++) yt.addSubscriber(make_shared<EmailSubscriber>("late" + to_string(i) + "@x.io"));
+    double restLateUs = chrono::duration<double, micro>(chrono::steady_clock::now() - l1).count() / (late - 1);
+
+    pipeline.drain();
+    double deliverMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    cout << subscribers << " single subscribes took " << (long)subscribeMs << " ms" << endl;
+    cout << "uploadContent returned after " << enqueueMs << " ms" << endl;
+    cout << "subscribes during delivery: first " << (long)firstLateMs << " ms (one roster copy), then "
+         << restLateUs << " us each" << endl;
+    cout << "delivered " << stub.delivered[(int)ChannelType::EMAIL] << " email + "
+         << stub.delivered[(int)ChannelType::PUSH] << " push in " << stub.batches << " batches, "
+         << (long)deliverMs << " ms" << endl;
+
+    return 0;
+}
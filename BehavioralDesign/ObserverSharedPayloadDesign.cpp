@@ -0,0 +1,293 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+using namespace std;
+
+/*
+    Why shared event payloads?
+    In ObserverDesign.cpp uploadContent passes the video by reference,
+    but every EmailSubscriber / PushSubscriber::notify builds
+        "Email: New video out " + video
+    which is one heap allocation per subscriber per upload. Once
+    delivery is queued (ObserverFanoutDesign.cpp) every queued copy of
+    that string is another allocation.
+
+    Here an upload is rendered once:
+    - SharedText is an immutable, reference-counted string living in a
+      single allocation (counter, length and bytes together); copying
+      it only bumps the counter
+    - each channel keeps a pre-rendered template per delivery type
+      ("Email: [CypherJet] New video out "), an UploadEvent renders
+      every template with the video exactly once
+    - subscribers and delivery queues hold SharedText, not strings
+    So a fan-out to N subscribers makes O(delivery types) payload
+    allocations instead of O(N).
+
+    The benchmark counts every operator new.
+*/
+
+// --------- Allocation counter ---------
+atomic<long> allocations{0};
+
+// kept out of line: once inlined, GCC pairs the malloc/free inside with
+// the library's operator new/delete and warns (-Wmismatched-new-delete)
+__attribute__((noinline)) void* operator new(size_t n) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+// --------- Shared payload ---------
+class SharedText {
+private:
+    struct Header {
+        atomic<long> refs;
+        size_t length;
+    };
+    Header* block = nullptr;
+
+    const char* chars() const { return reinterpret_cast<const char*>(block + 1); }
+
+    void release() {
+        if (block && block -> refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+            block -> ~Header();
+            ::operator delete(block);
+        }
+        block = nullptr;
+    }
+public:
+    SharedText() = default;
+
+    // one allocation for the concatenation of all parts
+    static SharedText concat(initializer_list<string_view> parts) {
+        size_t length = 0;
+        for (auto p : parts) length += p.size();
+        SharedText text;
+        text.block = new (::operator new(sizeof(Header) + length)) Header{{1}, length};
+        char* out = reinterpret_cast<char*>(text.block + 1);
+        for (auto p : parts) {
+            memcpy(out, p.data(), p.size());
+            out += p.size();
+        }
+        return text;
+    }
+
+    SharedText(const SharedText& other) : block(other.block) {
+        if (block) block -> refs.fetch_add(1, memory_order_relaxed);
+    }
+    SharedText(SharedText&& other) noexcept : block(other.block) { other.block = nullptr; }
+
+    SharedText& operator=(SharedText other) noexcept {
+        swap(block, other.block);
+        return *this;
+    }
+
+    ~SharedText() { release(); }
+
+    string_view view() const { return block ? string_view(chars(), block -> length) : string_view(); }
+    long useCount() const { return block ? block -> refs.load(memory_order_relaxed) : 0; }
+};
+
+// --------- Events ---------
+enum class ChannelType { EMAIL, PUSH, COUNT };
+
+// immutable once built, shared by every delivery of one upload
+struct UploadEvent {
+    SharedText video;
+    SharedText rendered[(int)ChannelType::COUNT];
+};
+
+class MessageWriter {
+public:
+    virtual void write(const string& address, string_view message) = 0;
+    virtual ~MessageWriter() {}
+};
+
+class ConsoleWriter : public MessageWriter {
+public:
+    void write(const string&, string_view message) override {
+        cout << message << endl;
+    }
+};
+
+// stands in for a provider call, only counts bytes
+class NullWriter : public MessageWriter {
+public:
+    size_t bytes = 0;
+    void write(const string&, string_view message) override { bytes += message.size(); }
+};
+
+class Subscriber {
+public:
+    virtual void notify(const UploadEvent& event, MessageWriter& out) = 0;
+    virtual ChannelType channel() const = 0;
+    virtual const string& address() const = 0;
+    virtual ~Subscriber() {}
+};
+
+class EmailSubscriber: public Subscriber {
+private:
+    string email;
+public:
+    EmailSubscriber(const string& email) : email(email) {}
+    void notify(const UploadEvent& event, MessageWriter& out) override {
+        out.write(email, event.rendered[(int)ChannelType::EMAIL].view());
+    }
+    ChannelType channel() const override { return ChannelType::EMAIL; }
+    const string& address() const override { return email; }
+};
+
+class PushSubscriber: public Subscriber {
+private:
+    string deviceToken;
+public:
+    PushSubscriber(const string& deviceToken) : deviceToken(deviceToken) {}
+    void notify(const UploadEvent& event, MessageWriter& out) override {
+        out.write(deviceToken, event.rendered[(int)ChannelType::PUSH].view());
+    }
+    ChannelType channel() const override { return ChannelType::PUSH; }
+    const string& address() const override { return deviceToken; }
+};
+
+// a queued delivery holds a reference to the rendered message, never a copy
+struct Delivery {
+    Subscriber* subscriber;
+    SharedText message;
+};
+
+class YoutubeChannel {
+private:
+    string uid;
+    string name;
+    vector<shared_ptr<Subscriber>> Subscribers;
+    string templates[(int)ChannelType::COUNT];      // rendered once per channel
+public:
+    YoutubeChannel(const string& uid, const string& name) : uid(uid), name(name) {
+        templates[(int)ChannelType::EMAIL] = "Email: [" + name + "] New video out ";
+        templates[(int)ChannelType::PUSH] = "Push: [" + name + "] New video out ";
+    }
+
+    void addSubscriber(shared_ptr<Subscriber> sub) {
+        Subscribers.push_back(sub);
+    }
+
+    // one allocation for the title plus one per delivery type
+    UploadEvent render(string_view video) const {
+        UploadEvent event;
+        event.video = SharedText::concat({video});
+        for (int t = 0; t < (int)ChannelType::COUNT; t++) {
+            event.rendered[t] = SharedText::concat({templates[t], video});
+        }
+        return event;
+    }
+
+    void uploadContent(const string& video, MessageWriter& out) {
+        UploadEvent event = render(video);
+        for (auto& s : Subscribers) s -> notify(event, out);
+    }
+
+    // asynchronous flavour: the queue shares the rendered payloads
+    void enqueueUpload(const string& video, vector<Delivery>& queue) {
+        UploadEvent event = render(video);
+        for (auto& s : Subscribers) queue.push_back({s.get(), event.rendered[(int)s -> channel()]});
+    }
+
+    size_t subscriberCount() const { return Subscribers.size(); }
+};
+
+// --------- Benchmark ---------
+// the notify of ObserverDesign.cpp: builds the message per subscriber
+class LegacySubscriber {
+public:
+    string address;
+    bool email;
+
+    void notify(const string& video, MessageWriter& out) {
+        string message = (email ? "Email: New video out " : "Push: New video out ") + video;
+        out.write(address, message);
+    }
+};
+
+struct Measure {
+    long allocs;
+    double nsPerDelivery;
+};
+
+template <typename Fn>
+Measure measure(size_t deliveries, Fn&& fn) {
+    long before = allocations.load();
+    auto t0 = chrono::steady_clock::now();
+    fn();
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count();
+    return {allocations.load() - before, ns / deliveries};
+}
+
+void report(const string& label, Measure m) {
+    cout << label << ": " << m.allocs << " allocations, " << m.nsPerDelivery << " ns/delivery" << endl;
+}
+
+int main() {
+    {
+        YoutubeChannel yt("11", "CypherJet");
+        ConsoleWriter console;
+
+        yt.addSubscriber(make_shared<EmailSubscriber>("example@example.com"));
+        yt.addSubscriber(make_shared<PushSubscriber>("device_token_123"));
+        yt.addSubscriber(make_shared<EmailSubscriber>("other@example.com"));
+        yt.uploadContent("LLM-DB-Search", console);
+
+        vector<Delivery> queue;
+        yt.enqueueUpload("Vector-Index-Deep-Dive", queue);
+        cout << "queued " << queue.size() << " deliveries, email message shared by "
+             << queue[0].message.useCount() << " holders" << endl;
+        for (auto& d : queue) cout << d.message.view() << endl;
+    }
+
+    const size_t subscribers = 1'000'000;
+    const string video = "Vector-Index-Deep-Dive-Part-2";
+    cout << "\n--- one upload to " << subscribers << " subscribers ---" << endl;
+
+    YoutubeChannel yt("12", "BigChannel");
+    vector<LegacySubscriber> legacy(subscribers);
+    for (size_t i = 0; i < subscribers; i++) {
+        bool email = i % 2;
+        legacy[i] = {(email ? "u" : "tok") + to_string(i), email};
+        if (email) yt.addSubscriber(make_shared<EmailSubscriber>(legacy[i].address));
+        else yt.addSubscriber(make_shared<PushSubscriber>(legacy[i].address));
+    }
+    NullWriter sink;
+
+    report("per-subscriber strings, sync ", measure(subscribers, [&] {
+        for (auto& s : legacy) s.notify(video, sink);
+    }));
+
+    vector<pair<LegacySubscriber*, string>> legacyQueue;
+    legacyQueue.reserve(subscribers);
+    report("per-subscriber strings, queued", measure(subscribers, [&] {
+        for (auto& s : legacy) legacyQueue.emplace_back(&s, (s.email ? "Email: New video out " : "Push: New video out ") + video);
+        for (auto& [s, message] : legacyQueue) sink.write(s -> address, message);
+    }));
+    legacyQueue = {};
+
+    report("shared payload, sync          ", measure(subscribers, [&] {
+        yt.uploadContent(video, sink);
+    }));
+
+    vector<Delivery> queue;
+    queue.reserve(subscribers);
+    report("shared payload, queued        ", measure(subscribers, [&] {
+        yt.enqueueUpload(video, queue);
+        for (auto& d : queue) sink.write(d.subscriber -> address(), d.message.view());
+    }));
+
+    return 0;
+}
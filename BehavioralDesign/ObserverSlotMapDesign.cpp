@@ -0,0 +1,328 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <string>
+using namespace std;
+
+/*
+    Why a slot map for subscribers?
+    In ObserverDesign.cpp removeSubscriber is an erase-remove over a
+    vector<shared_ptr<Subscriber>>, O(n) per unsubscribe. And if a
+    subscriber (un)subscribes from inside notify, the vector that
+    uploadContent is iterating changes under it.
+
+    SubscriberRegistry is a generational slot map:
+    - addSubscriber returns a stable handle (slot index + generation),
+      a stale handle is detected by its generation
+    - subscribers live in a dense array, notify walks it linearly
+    - removal swaps the last dense entry into the hole, O(1)
+
+    Mutations never touch the dense array directly. They mark the
+    entry dead (an atomic flag the notifier checks) and queue the
+    structural change. Queued changes are applied only at quiescent
+    points: before and after a fan-out, and by the mutator itself
+    when no fan-out is running (so a channel that never uploads does
+    not queue forever). A fan-out always walks a stable array, and
+    mutators from any thread only take a short lock that the notifier
+    never holds while notifying.
+*/
+
+class Subscriber {
+public:
+    virtual void notify(const string& video) = 0;
+    virtual ~Subscriber() {}
+};
+
+class EmailSubscriber: public Subscriber {
+private:
+    string email;
+public:
+    EmailSubscriber(const string& email) : email(email) {}
+    void notify(const string& video) override {
+        cout << "Email: New video out " + video << endl;
+    }
+};
+
+class PushSubscriber: public Subscriber {
+private:
+    string deviceToken;
+public:
+    PushSubscriber(const string& deviceToken) : deviceToken(deviceToken) {}
+    void notify(const string& video) override {
+        cout << "Push: New video out " + video << endl;
+    }
+};
+
+struct SubscriberHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+class SubscriberRegistry {
+private:
+    static constexpr uint32_t PENDING = UINT32_MAX;        // added, not yet in the dense array
+    static constexpr uint32_t CANCELLED = UINT32_MAX - 1;  // removed before it was applied
+
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t dense = PENDING;
+    };
+
+    // read by the notifier, changed only at quiescent points
+    vector<shared_ptr<Subscriber>> dense;
+    vector<uint32_t> denseSlot;
+    deque<atomic<bool>> live;
+
+    // guarded by lock
+    mutex lock;
+    vector<Slot> slots;
+    vector<uint32_t> freeSlots;
+    vector<pair<uint32_t, shared_ptr<Subscriber>>> pendingAdds;
+    vector<uint32_t> pendingRemovals;
+
+public:
+    SubscriberHandle add(shared_ptr<Subscriber> sub) {
+        lock_guard<mutex> guard(lock);
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            index = (uint32_t)slots.size();
+            slots.emplace_back();
+        }
+        slots[index].dense = PENDING;
+        pendingAdds.emplace_back(index, std::move(sub));
+        return {index, slots[index].generation};
+    }
+
+    // false for a stale or already removed handle
+    bool remove(SubscriberHandle h) {
+        lock_guard<mutex> guard(lock);
+        if (h.index >= slots.size() || slots[h.index].generation != h.generation) return false;
+
+        Slot& slot = slots[h.index];
+        slot.generation++;          // the handle is dead from now on
+        if (slot.dense == PENDING) {
+            slot.dense = CANCELLED;
+        }
+        else {
+            live[slot.dense].store(false, memory_order_release);
+        }
+        pendingRemovals.push_back(h.index);
+        return true;
+    }
+
+    // quiescent point: only the notifier calls this, never while iterating
+    void applyPending() {
+        lock_guard<mutex> guard(lock);
+        for (auto& [index, sub] : pendingAdds) {
+            if (slots[index].dense == CANCELLED) continue;     // freed below
+            slots[index].dense = (uint32_t)dense.size();
+            dense.push_back(std::move(sub));
+            denseSlot.push_back(index);
+            live.emplace_back(true);
+        }
+        pendingAdds.clear();
+
+        for (uint32_t index : pendingRemovals) {
+            Slot& slot = slots[index];
+            if (slot.dense != CANCELLED) {
+                uint32_t hole = slot.dense, last = (uint32_t)dense.size() - 1;
+                if (hole != last) {
+                    dense[hole] = std::move(dense[last]);
+                    denseSlot[hole] = denseSlot[last];
+                    live[hole].store(live[last].load(memory_order_relaxed), memory_order_relaxed);
+                    slots[denseSlot[hole]].dense = hole;
+                }
+                dense.pop_back();
+                denseSlot.pop_back();
+                live.pop_back();
+            }
+            slot.dense = PENDING;
+            freeSlots.push_back(index);
+        }
+        pendingRemovals.clear();
+    }
+
+    template <typename Fn>
+    void forEachLive(Fn&& fn) {
+        for (size_t i = 0; i < dense.size(); i++) {
+            if (live[i].load(memory_order_acquire)) fn(*dense[i]);
+        }
+    }
+
+    size_t size() const { return dense.size(); }
+
+    size_t pendingChanges() {
+        lock_guard<mutex> guard(lock);
+        return pendingAdds.size() + pendingRemovals.size();
+    }
+};
+
+class YoutubeChannel {
+private:
+    string uid;
+    string name;
+    SubscriberRegistry subscribers;
+    mutex notifying;        // one fan-out at a time
+
+    // fan-outs running on this thread; a mutator called from notify must
+    // not touch `notifying`, which its own thread may hold
+    static inline thread_local int fanOutDepth = 0;
+
+    struct FanOut {
+        FanOut() { fanOutDepth++; }
+        ~FanOut() { fanOutDepth--; }
+    };
+
+    // a running fan-out applies the queue itself when it ends
+    void applyIfQuiescent() {
+        if (fanOutDepth > 0 || !notifying.try_lock()) return;
+        subscribers.applyPending();
+        notifying.unlock();
+    }
+public:
+    YoutubeChannel(const string& uid, const string& name) : uid(uid), name(name) {}
+
+    SubscriberHandle addSubscriber(shared_ptr<Subscriber> sub) {
+        SubscriberHandle handle = subscribers.add(std::move(sub));
+        applyIfQuiescent();
+        return handle;
+    }
+
+    bool removeSubscriber(SubscriberHandle handle) {
+        bool removed = subscribers.remove(handle);
+        if (removed) applyIfQuiescent();
+        return removed;
+    }
+
+    // safe even if subscribers (un)subscribe from inside notify
+    void uploadContent(const string& video) {
+        lock_guard<mutex> guard(notifying);
+        FanOut running;
+        subscribers.applyPending();
+        subscribers.forEachLive([&](Subscriber& s) { s.notify(video); });
+        subscribers.applyPending();
+    }
+
+    size_t pendingChanges() { return subscribers.pendingChanges(); }
+
+    size_t subscriberCount() {
+        lock_guard<mutex> guard(notifying);
+        subscribers.applyPending();
+        return subscribers.size();
+    }
+};
+
+// unsubscribes itself the first time it is notified
+class OneShotSubscriber : public Subscriber {
+public:
+    YoutubeChannel* channel = nullptr;
+    SubscriberHandle self;
+
+    void notify(const string& video) override {
+        cout << "OneShot: New video out " + video + " (unsubscribing)" << endl;
+        channel -> removeSubscriber(self);
+    }
+};
+
+// --------- Benchmark ---------
+class NullSubscriber : public Subscriber {
+public:
+    void notify(const string&) override {}
+};
+
+double nanosPerOp(chrono::steady_clock::time_point t0, size_t ops) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count() / ops;
+}
+
+void unsubscribeCost(size_t count) {
+    mt19937 g(11);
+
+    // slot map
+    YoutubeChannel channel("1", "bench");
+    vector<SubscriberHandle> handles;
+    for (size_t i = 0; i < count; i++) handles.push_back(channel.addSubscriber(make_shared<NullSubscriber>()));
+    channel.subscriberCount();      // apply the adds
+    shuffle(handles.begin(), handles.end(), g);
+    const size_t removals = 10000;
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < removals; i++) channel.removeSubscriber(handles[i]);
+    channel.subscriberCount();      // includes applying the removals
+    double slotMap = nanosPerOp(t0, removals);
+
+    // the erase-remove from ObserverDesign.cpp
+    vector<shared_ptr<Subscriber>> flat;
+    for (size_t i = 0; i < count; i++) flat.push_back(make_shared<NullSubscriber>());
+    vector<shared_ptr<Subscriber>> victims(flat.begin(), flat.end());
+    shuffle(victims.begin(), victims.end(), g);
+    const size_t flatRemovals = count >= 1000000 ? 20 : 200;
+    t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < flatRemovals; i++) flat.erase(remove(flat.begin(), flat.end(), victims[i]), flat.end());
+    double eraseRemove = nanosPerOp(t0, flatRemovals);
+
+    cout << count << " subscribers: slot map " << slotMap << " ns/unsubscribe, erase-remove "
+         << (long)eraseRemove << " ns/unsubscribe" << endl;
+}
+
+int main() {
+    YoutubeChannel yt("11", "CypherJet");
+
+    auto sub1 = make_shared<EmailSubscriber>("example@example.com");
+    auto sub2 = make_shared<PushSubscriber>("device_token_123");
+    auto oneShot = make_shared<OneShotSubscriber>();
+
+    auto h1 = yt.addSubscriber(sub1);
+    auto h2 = yt.addSubscriber(sub2);
+    oneShot -> channel = &yt;
+    oneShot -> self = yt.addSubscriber(oneShot);
+
+    yt.uploadContent("LLM-DB-Search");
+    yt.uploadContent("Vector-Index-Deep-Dive");     // the one-shot subscriber is gone
+
+    yt.removeSubscriber(h1);
+    cout << "stale handle removed again: " << yt.removeSubscriber(h1) << endl;
+    yt.removeSubscriber(h2);
+    cout << "subscribers left: " << yt.subscriberCount() << endl;
+
+    // a channel that never uploads still applies its changes
+    {
+        YoutubeChannel quiet("13", "Quiet");
+        for (int i = 0; i < 100000; i++) quiet.removeSubscriber(quiet.addSubscriber(make_shared<NullSubscriber>()));
+        cout << "queued changes after 100000 subscribe / unsubscribe pairs: " << quiet.pendingChanges() << endl;
+    }
+
+    // another thread churns subscribers while the channel keeps uploading
+    {
+        YoutubeChannel busy("12", "Churn");
+        vector<SubscriberHandle> base;
+        for (int i = 0; i < 100000; i++) base.push_back(busy.addSubscriber(make_shared<NullSubscriber>()));
+        atomic<bool> stop{false};
+        thread churn([&] {
+            size_t i = 0;
+            while (!stop.load()) {
+                busy.removeSubscriber(base[i % base.size()]);
+                base[i % base.size()] = busy.addSubscriber(make_shared<NullSubscriber>());
+                i++;
+            }
+        });
+        for (int i = 0; i < 200; i++) busy.uploadContent("Clip " + to_string(i));
+        stop = true;
+        churn.join();
+        cout << "after churn during 200 uploads: " << busy.subscriberCount() << " subscribers" << endl;
+    }
+
+    cout << "\n--- unsubscribe cost as the channel grows ---" << endl;
+    for (size_t n : {10000, 100000, 1000000, 4000000}) unsubscribeCost(n);
+
+    return 0;
+}
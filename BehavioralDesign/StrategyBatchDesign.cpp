@@ -0,0 +1,542 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <span>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+using namespace std;
+
+/*
+    Why batch payments with idempotency keys?
+    PaymentProcessor in StrategyDesign.cpp charges one amount per call
+    and has no idea which request it is charging, so a client that
+    retries after a timeout pays twice. Each call also pays the
+    provider's per-call overhead (session, handshake) on its own.
+
+    PaymentBatchProcessor takes a batch of payments, each with an
+    idempotency key and the strategy that should charge it:
+    - keys are claimed in IdempotencyTable, a lock-free open-addressing
+      table of (key hash, expiry); the first claim of a key wins, later
+      ones are reported as duplicates until the entry expires
+    - the new payments are grouped by strategy (counting sort), and
+      each strategy gets sub-batches through processPayments(), so the
+      per-call overhead is paid once per sub-batch
+    - claiming and charging run in parallel on a small worker pool
+    - a provider reports how many payments of a sub-batch it charged;
+      the keys of the ones it did not charge are released so the
+      client's retry goes through, the charged ones stay claimed
+    - a duplicate of a key claimed earlier in the same batch gets the
+      status of that payment once it is known, so a duplicate of a
+      failed payment is reported failed, not paid
+    Keys are stored as 64-bit hashes; two different keys would have to
+    collide in 64 bits to be mistaken for each other.
+*/
+
+// --------- Strategies ---------
+class PaymentStrategy {
+public:
+    virtual void processPayment(int amt) = 0;
+
+    // a whole group for this provider: charges a prefix of amounts and
+    // returns its length; an override that throws must have charged nothing
+    virtual size_t processPayments(span<const int> amounts) {
+        size_t charged = 0;
+        try {
+            for (int amt : amounts) {
+                processPayment(amt);
+                charged++;
+            }
+        } catch (const exception&) {}
+        return charged;
+    }
+
+    virtual ~PaymentStrategy() {}
+};
+
+class CreditCard : public PaymentStrategy {
+public:
+    void processPayment(int amt) override {
+        cout <<  to_string(amt) + " Paid using CreditCard" << endl;
+    }
+};
+
+class DebitCard : public PaymentStrategy {
+public:
+    void processPayment(int amt) override {
+        cout <<  to_string(amt) + " Paid using DebitCard" << endl;
+    }
+};
+
+// --------- Idempotency table ---------
+class IdempotencyTable {
+private:
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr uint64_t CLAIMING = UINT64_MAX;    // expiry and owner not written yet, counts as live
+
+    struct Slot {
+        atomic<uint64_t> key{EMPTY};
+        atomic<uint64_t> expiresAt{CLAIMING};
+        atomic<uint64_t> owner{0};                      // caller's tag for the current claim
+    };
+
+    static uint64_t settledExpiry(Slot& s) {
+        uint64_t expires;
+        while ((expires = s.expiresAt.load(memory_order_acquire)) == CLAIMING) this_thread::yield();
+        return expires;
+    }
+
+    unique_ptr<Slot[]> slots;
+    size_t mask;
+    atomic<size_t> occupied{0};
+
+    Slot* find(uint64_t key) {
+        for (size_t i = key & mask; ; i = (i + 1) & mask) {
+            uint64_t k = slots[i].key.load(memory_order_acquire);
+            if (k == key) return &slots[i];
+            if (k == EMPTY) return nullptr;
+        }
+    }
+public:
+    enum Status { NEW, DUPLICATE };
+
+    struct Claim {
+        Status status;
+        uint64_t owner;                 // the tag of whoever holds the key, ours if NEW
+    };
+
+    IdempotencyTable(size_t capacity) {
+        size_t c = 16;
+        while (c < capacity) c <<= 1;
+        slots = make_unique<Slot[]>(c);
+        mask = c - 1;
+    }
+
+    static uint64_t hashKey(string_view key) {
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (unsigned char c : key) h = (h ^ c) * 0x100000001B3ULL;
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+        h ^= h >> 31;
+        return h == EMPTY ? 1 : h;
+    }
+
+    // safe from many threads at once, as long as the table is not full
+    Claim claim(uint64_t key, uint64_t owner, uint64_t nowMs, uint64_t ttlMs) {
+        for (size_t i = key & mask; ; i = (i + 1) & mask) {
+            Slot& s = slots[i];
+            uint64_t k = s.key.load(memory_order_acquire);
+            if (k == EMPTY) {
+                if (s.key.compare_exchange_strong(k, key, memory_order_acq_rel)) {
+                    s.owner.store(owner, memory_order_relaxed);
+                    s.expiresAt.store(nowMs + ttlMs, memory_order_release);
+                    occupied.fetch_add(1, memory_order_relaxed);
+                    return {NEW, owner};
+                }
+                // k now holds whoever won the slot
+            }
+            if (k != key) continue;
+
+            // our key: live means duplicate, expired may be renewed by exactly one claimant
+            uint64_t expires = settledExpiry(s);
+            while (expires <= nowMs) {
+                if (s.expiresAt.compare_exchange_weak(expires, CLAIMING, memory_order_acq_rel)) {
+                    s.owner.store(owner, memory_order_relaxed);
+                    s.expiresAt.store(nowMs + ttlMs, memory_order_release);
+                    return {NEW, owner};
+                }
+                if (expires == CLAIMING) expires = settledExpiry(s);
+            }
+            return {DUPLICATE, s.owner.load(memory_order_relaxed)};
+        }
+    }
+
+    // lets the next claim of the key through, e.g. after a failed charge
+    void release(uint64_t key) {
+        if (Slot* s = find(key)) s -> expiresAt.store(0, memory_order_release);
+    }
+
+    size_t capacity() const { return mask + 1; }
+    size_t size() const { return occupied.load(memory_order_relaxed); }
+
+    // not concurrent with claim(): drops expired entries, growing so that
+    // `incoming` more keys keep the load factor under a half
+    void purge(uint64_t nowMs, size_t incoming) {
+        size_t live = 0;
+        for (size_t i = 0; i <= mask; i++) {
+            uint64_t k = slots[i].key.load(memory_order_relaxed);
+            live += k != EMPTY && slots[i].expiresAt.load(memory_order_relaxed) > nowMs;
+        }
+        size_t c = capacity();
+        while ((live + incoming) * 2 > c) c <<= 1;
+
+        auto old = std::move(slots);
+        size_t oldCapacity = mask + 1;
+        slots = make_unique<Slot[]>(c);
+        mask = c - 1;
+        occupied.store(0, memory_order_relaxed);
+        for (size_t i = 0; i < oldCapacity; i++) {
+            uint64_t k = old[i].key.load(memory_order_relaxed);
+            uint64_t expires = old[i].expiresAt.load(memory_order_relaxed);
+            if (k == EMPTY || expires <= nowMs) continue;
+            size_t j = k & mask;
+            while (slots[j].key.load(memory_order_relaxed) != EMPTY) j = (j + 1) & mask;
+            slots[j].key.store(k, memory_order_relaxed);
+            slots[j].expiresAt.store(expires, memory_order_relaxed);
+            slots[j].owner.store(old[i].owner.load(memory_order_relaxed), memory_order_relaxed);
+            occupied.fetch_add(1, memory_order_relaxed);
+        }
+    }
+};
+
+// --------- Worker pool ---------
+// runs fn(0) .. fn(jobs - 1) on the pool and the calling thread
+class WorkerPool {
+private:
+    vector<thread> threads;
+    mutex m;
+    condition_variable wake, done;
+    const function<void(size_t)>* job = nullptr;
+    size_t jobs = 0;
+    atomic<size_t> nextJob{0};
+    uint64_t generation = 0;
+    size_t finished = 0;
+    bool stopping = false;
+
+    void runJobs(const function<void(size_t)>& fn, size_t count) {
+        for (size_t j; (j = nextJob.fetch_add(1)) < count; ) fn(j);
+    }
+
+    void loop() {
+        uint64_t seen = 0;
+        while (true) {
+            const function<void(size_t)>* fn;
+            size_t count;
+            {
+                unique_lock<mutex> lock(m);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                fn = job;
+                count = jobs;
+            }
+            runJobs(*fn, count);
+            lock_guard<mutex> lock(m);
+            if (++finished == threads.size()) done.notify_one();
+        }
+    }
+public:
+    WorkerPool(size_t helpers) {
+        for (size_t i = 0; i < helpers; i++) threads.emplace_back([this] { loop(); });
+    }
+
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> lock(m);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    void parallelFor(size_t count, const function<void(size_t)>& fn) {
+        {
+            lock_guard<mutex> lock(m);
+            job = &fn;
+            jobs = count;
+            nextJob.store(0);
+            finished = 0;
+            generation++;
+        }
+        wake.notify_all();
+        runJobs(fn, count);
+        unique_lock<mutex> lock(m);
+        done.wait(lock, [&] { return finished == threads.size(); });
+    }
+
+    size_t size() const { return threads.size() + 1; }
+};
+
+// --------- Batch processor ---------
+struct Payment {
+    string idempotencyKey;
+    int amount;
+    size_t strategy;                    // index given by addStrategy()
+};
+
+enum class PaymentStatus : uint8_t { CHARGED, DUPLICATE, FAILED };
+
+class PaymentBatchProcessor {
+private:
+    static constexpr size_t CLAIM_CHUNK = 4096;
+
+    vector<unique_ptr<PaymentStrategy>> strategies;     // must tolerate concurrent processPayments()
+    IdempotencyTable keys;
+    uint64_t ttlMs;
+    size_t providerBatch;
+    WorkerPool pool;
+    mutex batchLock;                    // one batch at a time, the parallelism is inside
+    uint64_t batches = 0;               // claims are tagged (batch << 32) | position
+
+    static uint64_t nowMs() {
+        return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+public:
+    PaymentBatchProcessor(chrono::milliseconds ttl, size_t providerBatch = 1024,
+                          size_t threads = max(1u, thread::hardware_concurrency()))
+        : keys(1 << 16), ttlMs(ttl.count()), providerBatch(providerBatch), pool(threads - 1) {}
+
+    size_t addStrategy(unique_ptr<PaymentStrategy> pm) {
+        strategies.push_back(std::move(pm));
+        return strategies.size() - 1;
+    }
+
+    vector<PaymentStatus> processBatch(span<const Payment> payments) {
+        lock_guard<mutex> lock(batchLock);
+        uint64_t now = nowMs();
+        size_t n = payments.size();
+        for (auto& p : payments) {
+            if (p.strategy >= strategies.size()) throw invalid_argument("unknown payment strategy");
+        }
+        if (n > UINT32_MAX) throw length_error("batch too large");
+        if ((keys.size() + n) * 2 > keys.capacity()) keys.purge(now, n);
+        uint64_t batch = ++batches;
+
+        // claim every key, in parallel; original[i] is the position in this
+        // batch that claimed a duplicate's key, or n if it was an earlier batch
+        vector<PaymentStatus> status(n);
+        vector<uint64_t> hashes(n);
+        vector<uint32_t> original(n);
+        pool.parallelFor((n + CLAIM_CHUNK - 1) / CLAIM_CHUNK, [&](size_t chunk) {
+            for (size_t i = chunk * CLAIM_CHUNK; i < min(n, (chunk + 1) * CLAIM_CHUNK); i++) {
+                hashes[i] = IdempotencyTable::hashKey(payments[i].idempotencyKey);
+                auto claim = keys.claim(hashes[i], (batch << 32) | i, now, ttlMs);
+                status[i] = claim.status == IdempotencyTable::NEW ? PaymentStatus::CHARGED : PaymentStatus::DUPLICATE;
+                original[i] = claim.owner >> 32 == batch ? (uint32_t)claim.owner : (uint32_t)n;
+            }
+        });
+
+        // group the new payments by strategy
+        vector<size_t> start(strategies.size() + 1, 0);
+        for (size_t i = 0; i < n; i++) {
+            if (status[i] == PaymentStatus::CHARGED) start[payments[i].strategy + 1]++;
+        }
+        for (size_t s = 0; s < strategies.size(); s++) start[s + 1] += start[s];
+        vector<size_t> order(start.back());
+        vector<size_t> fill(start.begin(), start.end() - 1);
+        for (size_t i = 0; i < n; i++) {
+            if (status[i] == PaymentStatus::CHARGED) order[fill[payments[i].strategy]++] = i;
+        }
+
+        // one job per sub-batch of a strategy's group
+        struct Job {
+            size_t strategy, begin, end;
+        };
+        vector<Job> jobs;
+        for (size_t s = 0; s < strategies.size(); s++) {
+            for (size_t b = start[s]; b < start[s + 1]; b += providerBatch) jobs.push_back({s, b, min(start[s + 1], b + providerBatch)});
+        }
+        pool.parallelFor(jobs.size(), [&](size_t j) {
+            const Job& job = jobs[j];
+            vector<int> amounts;
+            amounts.reserve(job.end - job.begin);
+            for (size_t k = job.begin; k < job.end; k++) amounts.push_back(payments[order[k]].amount);
+            size_t charged = 0;
+            try {
+                charged = min(amounts.size(), strategies[job.strategy] -> processPayments(amounts));
+            } catch (const exception&) {}
+            // only what was not charged may be retried
+            for (size_t k = job.begin + charged; k < job.end; k++) {
+                status[order[k]] = PaymentStatus::FAILED;
+                keys.release(hashes[order[k]]);
+            }
+        });
+
+        // a duplicate of a payment in this batch shares its fate
+        for (size_t i = 0; i < n; i++) {
+            if (status[i] == PaymentStatus::DUPLICATE && original[i] < n && original[i] != i &&
+                status[original[i]] == PaymentStatus::FAILED) status[i] = PaymentStatus::FAILED;
+        }
+        return status;
+    }
+
+    size_t trackedKeys() const { return keys.size(); }
+};
+
+// --------- Benchmark ---------
+// a local provider: every call pays a fixed session cost, then a small cost per charge
+class StubProvider : public PaymentStrategy {
+private:
+    atomic<uint64_t> sessions{0}, charges{0}, total{0};
+    atomic<bool> down{false};
+
+    static void openSession() {
+        volatile uint64_t handshake = 0;
+        for (int i = 0; i < 1000; i++) handshake = handshake * 31 + i;     // ~1 us of work
+    }
+public:
+    void processPayment(int amt) override {
+        processPayments(span<const int>(&amt, 1));
+    }
+
+    size_t processPayments(span<const int> amounts) override {
+        if (down.load(memory_order_relaxed)) throw runtime_error("provider unavailable");
+        openSession();
+        uint64_t sum = 0;
+        for (int amt : amounts) sum += amt;
+        sessions.fetch_add(1, memory_order_relaxed);
+        charges.fetch_add(amounts.size(), memory_order_relaxed);
+        total.fetch_add(sum, memory_order_relaxed);
+        return amounts.size();
+    }
+
+    void setDown(bool d) { down = d; }
+    uint64_t sessionCount() const { return sessions.load(); }
+    uint64_t chargeCount() const { return charges.load(); }
+    uint64_t totalCharged() const { return total.load(); }
+};
+
+// charges one payment at a time and times out on its 3rd call
+class FlakyProvider : public PaymentStrategy {
+public:
+    int calls = 0, charges = 0;
+    void processPayment(int) override {
+        if (++calls == 3) throw runtime_error("provider timed out");
+        charges++;
+    }
+};
+
+class PaymentProcessor {
+private:
+    PaymentStrategy* paymentStrategy;
+public:
+    PaymentProcessor(PaymentStrategy* pm) : paymentStrategy(pm) {}
+
+    void processPayment(int amt) {
+        paymentStrategy -> processPayment(amt);
+    }
+
+    void setPaymentStrategy(PaymentStrategy* pm) {
+        paymentStrategy = pm;
+    }
+};
+
+double secondsSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+const char* statusName(PaymentStatus s) {
+    switch (s) {
+        case PaymentStatus::CHARGED: return "charged";
+        case PaymentStatus::DUPLICATE: return "duplicate";
+        case PaymentStatus::FAILED: return "failed";
+    }
+    return "?";
+}
+
+int main() {
+    {
+        PaymentBatchProcessor processor(chrono::milliseconds(50));
+        size_t cc = processor.addStrategy(make_unique<CreditCard>());
+        size_t dc = processor.addStrategy(make_unique<DebitCard>());
+        auto upi = make_unique<StubProvider>();
+        StubProvider* upiProvider = upi.get();
+        size_t up = processor.addStrategy(std::move(upi));
+
+        upiProvider -> setDown(true);
+        vector<Payment> batch = {
+            {"order-1", 1000, cc},
+            {"order-2", 2000, dc},
+            {"order-1", 1000, cc},      // client retry
+            {"order-3", 1500, cc},
+            {"order-4", 700, up},
+        };
+        auto status = processor.processBatch(batch);
+        for (size_t i = 0; i < batch.size(); i++) cout << batch[i].idempotencyKey << ": " << statusName(status[i]) << endl;
+
+        cout << "\n--- retry while the keys are live, provider back up ---" << endl;
+        upiProvider -> setDown(false);
+        status = processor.processBatch(batch);
+        for (size_t i = 0; i < batch.size(); i++) cout << batch[i].idempotencyKey << ": " << statusName(status[i]) << endl;
+
+        cout << "\n--- after the 50 ms expiry ---" << endl;
+        this_thread::sleep_for(chrono::milliseconds(60));
+        status = processor.processBatch(span<const Payment>(batch).first(1));
+        cout << batch[0].idempotencyKey << ": " << statusName(status[0]) << endl;
+
+        cout << "\n--- provider fails halfway through a sub-batch, then the client retries ---" << endl;
+        auto flaky = make_unique<FlakyProvider>();
+        FlakyProvider* flakyProvider = flaky.get();
+        size_t fl = processor.addStrategy(std::move(flaky));
+        vector<Payment> partial;
+        for (int i = 1; i <= 5; i++) partial.push_back({"flaky-" + to_string(i), 100 * i, fl});
+        partial.push_back(partial[3]);  // duplicate of a payment that will fail
+        for (int round = 0; round < 2; round++) {
+            status = processor.processBatch(partial);
+            for (size_t i = 0; i < partial.size(); i++) cout << partial[i].idempotencyKey << ": " << statusName(status[i]) << (i + 1 < partial.size() ? ", " : "\n");
+        }
+        cout << flakyProvider -> charges << " charges for 5 distinct keys" << endl;
+    }
+
+    // n payments over three providers, every 20th one sent again later as a retry
+    const size_t n = 2'000'000, batchSize = 65'536;
+    cout << "\n--- " << n << " payments, " << batchSize << " per batch ---" << endl;
+    vector<Payment> payments;
+    payments.reserve(n + n / 20);
+    mt19937 rng(7);
+    for (size_t i = 0; i < n; i++) payments.push_back({"order-" + to_string(i) + "-" + to_string(rng()), int(rng() % 10'000) + 1, rng() % 3});
+    for (size_t i = 0; i < n; i += 20) payments.push_back(payments[i + (rng() % 20)]);
+    uint64_t expectedTotal = 0;
+    for (size_t i = 0; i < n; i++) expectedTotal += payments[i].amount;
+
+    {
+        StubProvider providers[3];
+        PaymentProcessor pp(&providers[0]);
+        auto t0 = chrono::steady_clock::now();
+        for (auto& p : payments) {
+            pp.setPaymentStrategy(&providers[p.strategy]);
+            pp.processPayment(p.amount);
+        }
+        double seconds = secondsSince(t0);
+        uint64_t charged = 0, total = 0;
+        for (auto& p : providers) {
+            charged += p.chargeCount();
+            total += p.totalCharged();
+        }
+        cout << "one at a time: " << (uint64_t)(payments.size() / seconds / 1000) << "k payments/s, "
+             << charged - n << " double charges, " << total - expectedTotal << " overcharged" << endl;
+    }
+
+    PaymentBatchProcessor processor(chrono::minutes(10));
+    StubProvider* providers[3];
+    for (auto& p : providers) {
+        auto provider = make_unique<StubProvider>();
+        p = provider.get();
+        processor.addStrategy(std::move(provider));
+    }
+    size_t counts[3] = {};
+    auto t0 = chrono::steady_clock::now();
+    for (size_t b = 0; b < payments.size(); b += batchSize) {
+        auto batch = span<const Payment>(payments).subspan(b, min(batchSize, payments.size() - b));
+        for (PaymentStatus s : processor.processBatch(batch)) counts[(int)s]++;
+    }
+    double seconds = secondsSince(t0);
+    uint64_t total = 0, sessions = 0;
+    for (auto* p : providers) {
+        total += p -> totalCharged();
+        sessions += p -> sessionCount();
+    }
+    cout << "batched:       " << (uint64_t)(payments.size() / seconds / 1000) << "k payments/s, "
+         << counts[(int)PaymentStatus::CHARGED] << " charged, " << counts[(int)PaymentStatus::DUPLICATE] << " duplicates, "
+         << sessions << " provider sessions, " << (int64_t)(total - expectedTotal) << " overcharged, "
+         << processor.trackedKeys() << " keys tracked" << endl;
+
+    return 0;
+}
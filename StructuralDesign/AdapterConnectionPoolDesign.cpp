@@ -0,0 +1,322 @@
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <string>
+using namespace std;
+
+/*
+    Why a Connection Pool behind the Adapters?
+    In AdapterDesign.cpp every turnOn() connects to the device
+    and every turnOff() disconnects again, so each command pays
+    a full Bluetooth / WiFi handshake.
+
+    Here the adapters stop owning the link. They hand commands
+    to a DeviceConnectionPool which
+    - keeps one link per device alive until it is idle too long
+    - reconnects lazily on the next command after expiry
+    - pipelines queued commands so several of them share
+      one round trip over the same link
+    - sends a batch that does not fill up once its first command
+      has waited the linger time, checked on every submit and by
+      flushDue(), so a lone command is never stuck in the queue
+
+    SimulatedTransport stands in for the real radios. It only
+    sleeps for the handshake / round trip latency.
+*/
+
+using Clock = chrono::steady_clock;
+
+// --------- Transport ---------
+struct TransportLatency {
+    chrono::microseconds handshake;
+    chrono::microseconds roundTrip;
+    chrono::microseconds perCommand;
+};
+
+class SimulatedTransport {
+private:
+    TransportLatency latency;
+    bool connected = false;
+    long handshakes = 0;
+public:
+    SimulatedTransport(TransportLatency latency) : latency(latency) {}
+
+    void connect() {
+        this_thread::sleep_for(latency.handshake);
+        connected = true;
+        handshakes++;
+    }
+
+    void disconnect() {
+        connected = false;
+    }
+
+    bool isConnected() const { return connected; }
+    long getHandshakes() const { return handshakes; }
+
+    // one round trip carries the whole batch
+    void send(const vector<string>& commands) {
+        if (!connected) throw runtime_error("send on closed link");
+        this_thread::sleep_for(latency.roundTrip + latency.perCommand * (long)commands.size());
+    }
+};
+
+// --------- Adaptees ---------
+class AirConditioner {
+public:
+    static constexpr TransportLatency bluetooth{chrono::microseconds(400), chrono::microseconds(80), chrono::microseconds(2)};
+
+    string startCooling() { return "AC:startCooling"; }
+    string stopCooling() { return "AC:stopCooling"; }
+};
+
+class SmartLight {
+public:
+    static constexpr TransportLatency wifi{chrono::microseconds(250), chrono::microseconds(50), chrono::microseconds(2)};
+
+    string switchOn() { return "Light:switchOn"; }
+    string switchOff() { return "Light:switchOff"; }
+};
+
+// --------- Connection Pool ---------
+class DeviceConnectionPool {
+private:
+    struct Connection {
+        unique_ptr<SimulatedTransport> transport;
+        Clock::time_point lastUsed;
+        vector<string> pending;
+        Clock::time_point firstQueued;      // when the oldest pending command was queued
+    };
+
+    unordered_map<string, Connection> connections;
+    chrono::milliseconds idleTimeout;
+    size_t pipelineDepth;
+    chrono::microseconds linger;
+
+    Connection& connection(const string& deviceId) {
+        auto it = connections.find(deviceId);
+        if (it == connections.end()) throw runtime_error("Unknown device: " + deviceId);
+        return it -> second;
+    }
+
+    const Connection& connection(const string& deviceId) const {
+        auto it = connections.find(deviceId);
+        if (it == connections.end()) throw runtime_error("Unknown device: " + deviceId);
+        return it -> second;
+    }
+
+    void acquire(Connection& conn) {
+        auto now = Clock::now();
+        if (conn.transport -> isConnected() && now - conn.lastUsed > idleTimeout) {
+            conn.transport -> disconnect();     // expired, reconnect lazily below
+        }
+        if (!conn.transport -> isConnected()) {
+            conn.transport -> connect();
+        }
+        conn.lastUsed = now;
+    }
+
+    void send(Connection& conn) {
+        if (conn.pending.empty()) return;
+        acquire(conn);
+        conn.transport -> send(conn.pending);
+        conn.pending.clear();
+        conn.lastUsed = Clock::now();
+    }
+
+public:
+    DeviceConnectionPool(chrono::milliseconds idleTimeout, size_t pipelineDepth = 1,
+                         chrono::microseconds linger = chrono::milliseconds(5))
+        : idleTimeout(idleTimeout), pipelineDepth(max<size_t>(1, pipelineDepth)), linger(linger) {}
+
+    void registerDevice(const string& deviceId, TransportLatency latency) {
+        connections[deviceId] = Connection{make_unique<SimulatedTransport>(latency), Clock::now(), {}, {}};
+    }
+
+    // queue a command, the batch goes out once the pipeline is full or has lingered
+    void submit(const string& deviceId, string command) {
+        Connection& conn = connection(deviceId);
+        if (conn.pending.empty()) conn.firstQueued = Clock::now();
+        conn.pending.push_back(std::move(command));
+        if (conn.pending.size() >= pipelineDepth) send(conn);
+        flushDue();
+    }
+
+    void flush(const string& deviceId) {
+        send(connection(deviceId));
+    }
+
+    // send every batch whose first command has waited the linger time
+    void flushDue() {
+        auto now = Clock::now();
+        for (auto& [id, conn] : connections) {
+            if (!conn.pending.empty() && now - conn.firstQueued >= linger) send(conn);
+        }
+    }
+
+    void flushAll() {
+        for (auto& [id, conn] : connections) send(conn);
+    }
+
+    // close links which have not been used within the idle timeout
+    void evictIdle() {
+        flushDue();
+        auto now = Clock::now();
+        for (auto& [id, conn] : connections) {
+            if (conn.pending.empty() && conn.transport -> isConnected() && now - conn.lastUsed > idleTimeout) {
+                conn.transport -> disconnect();
+            }
+        }
+    }
+
+    long handshakes(const string& deviceId) const {
+        return connection(deviceId).transport -> getHandshakes();
+    }
+};
+
+// --------- Target + Adapters ---------
+class SmartDevice {
+public:
+    virtual void turnOn() = 0;
+    virtual void turnOff() = 0;
+    virtual ~SmartDevice() {}
+};
+
+class AirConditionerAdapter : public SmartDevice {
+private:
+    unique_ptr<AirConditioner> airConditioner;
+    DeviceConnectionPool& pool;
+    string deviceId;
+public:
+    AirConditionerAdapter(unique_ptr<AirConditioner> ac, DeviceConnectionPool& pool, const string& deviceId)
+        : airConditioner(std::move(ac)), pool(pool), deviceId(deviceId) {
+        pool.registerDevice(deviceId, AirConditioner::bluetooth);
+    }
+
+    void turnOn() override {
+        pool.submit(deviceId, airConditioner -> startCooling());
+    }
+
+    void turnOff() override {
+        pool.submit(deviceId, airConditioner -> stopCooling());
+    }
+};
+
+class SmartLightAdapter : public SmartDevice {
+private:
+    unique_ptr<SmartLight> smartLight;
+    DeviceConnectionPool& pool;
+    string deviceId;
+public:
+    SmartLightAdapter(unique_ptr<SmartLight> sm, DeviceConnectionPool& pool, const string& deviceId)
+        : smartLight(std::move(sm)), pool(pool), deviceId(deviceId) {
+        pool.registerDevice(deviceId, SmartLight::wifi);
+    }
+
+    void turnOn() override {
+        pool.submit(deviceId, smartLight -> switchOn());
+    }
+
+    void turnOff() override {
+        pool.submit(deviceId, smartLight -> switchOff());
+    }
+};
+
+// --------- Benchmark ---------
+struct BenchResult {
+    double commandsPerSec;
+    double p99Micros;
+};
+
+BenchResult report(const string& label, vector<double>& latencies, chrono::duration<double> elapsed) {
+    sort(latencies.begin(), latencies.end());
+    double p99 = latencies[min(latencies.size() - 1, latencies.size() * 99 / 100)];
+    double cps = latencies.size() / elapsed.count();
+    cout << label << ": " << (long)cps << " cmds/sec, p99 " << (long)p99 << " us" << endl;
+    return {cps, p99};
+}
+
+// old behaviour: connect, send one command, disconnect
+BenchResult benchUnpooled(int commands) {
+    SimulatedTransport link(SmartLight::wifi);
+    SmartLight light;
+    vector<double> latencies;
+
+    auto start = Clock::now();
+    for (int i = 0; i < commands; i++) {
+        auto t0 = Clock::now();
+        link.connect();
+        link.send({i % 2 ? light.switchOff() : light.switchOn()});
+        link.disconnect();
+        latencies.push_back(chrono::duration<double, micro>(Clock::now() - t0).count());
+    }
+    return report("Unpooled", latencies, Clock::now() - start);
+}
+
+BenchResult benchPooled(int commands, size_t pipelineDepth) {
+    DeviceConnectionPool pool(chrono::milliseconds(500), pipelineDepth);
+    SmartLightAdapter light(make_unique<SmartLight>(), pool, "light-1");
+    vector<double> latencies;
+    vector<Clock::time_point> queued;   // enqueue times of the in-flight batch
+
+    auto start = Clock::now();
+    for (int i = 0; i < commands; i++) {
+        queued.push_back(Clock::now());
+        if (i % 2) light.turnOff();
+        else light.turnOn();
+
+        // a command completes when its batch has been sent
+        if (queued.size() >= pipelineDepth || i == commands - 1) {
+            pool.flush("light-1");
+            auto done = Clock::now();
+            for (auto& t0 : queued) latencies.push_back(chrono::duration<double, micro>(done - t0).count());
+            queued.clear();
+        }
+    }
+    return report("Pooled, pipeline x" + to_string(pipelineDepth), latencies, Clock::now() - start);
+}
+
+int main() {
+    // Smart Home Controller
+
+    DeviceConnectionPool pool(chrono::milliseconds(50), 2);
+    SmartLightAdapter smartLightAdapter(make_unique<SmartLight>(), pool, "light-1");
+    AirConditionerAdapter airConditionerAdapter(make_unique<AirConditioner>(), pool, "ac-1");
+
+    smartLightAdapter.turnOn();
+    airConditionerAdapter.turnOn();
+    airConditionerAdapter.turnOff();    // AC batch goes out here
+    smartLightAdapter.turnOff();        // light batch goes out here
+    smartLightAdapter.turnOn();
+    pool.flushAll();
+
+    cout << "light handshakes: " << pool.handshakes("light-1") << endl;
+    cout << "ac handshakes: " << pool.handshakes("ac-1") << endl;
+
+    this_thread::sleep_for(chrono::milliseconds(60));
+    pool.evictIdle();
+    smartLightAdapter.turnOff();        // waits for a second command or the linger time
+    this_thread::sleep_for(chrono::milliseconds(10));
+    pool.flushDue();
+    cout << "light handshakes after idle timeout: " << pool.handshakes("light-1") << endl;
+
+    try {
+        pool.submit("fan-1", "Fan:spin");
+    }
+    catch (const runtime_error& e) {
+        cout << e.what() << endl;
+    }
+
+    cout << "\n--- Benchmark (2000 commands) ---" << endl;
+    const int commands = 2000;
+    benchUnpooled(commands);
+    benchPooled(commands, 1);
+    benchPooled(commands, 8);
+
+    return 0;
+}
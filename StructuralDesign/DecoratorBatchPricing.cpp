@@ -0,0 +1,280 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+using namespace std;
+
+/*
+    Why Batch Pricing?
+    DecoratorDesign.cpp prices an order by walking its decorator
+    chain, one virtual getCost() per layer. That is fine for one
+    order, not for millions of orders a day.
+
+    A decorated Coffee is fully described by its base product and
+    how many times each add-on was applied. So the batch engine
+    takes orders as columns
+        product[i]          base product ID
+        addOns[k][i]        count of add-on k on order i
+    and prices them against flat price tables:
+        total[i] = basePrice[product[i]] + sum_k addOnPrice[k] * addOns[k][i]
+
+    Prices are kept in integer cents, so every total is exact whatever
+    the menu prices are and in whatever order the terms are added; the
+    decorator's double total rounds to the same number of cents.
+
+    The kernel processes 8 orders per step with AVX2 (gather for the
+    base price, multiply-add per add-on column). It is compiled with a
+    target attribute and picked at runtime, so the same binary runs the
+    scalar loop on CPUs without AVX2. Large batches are split across
+    threads.
+*/
+
+// --------- Object graph path (from DecoratorDesign.cpp) ---------
+// add-on price list, shared by the decorators and the batch engine
+struct Milk {
+    static constexpr double cost = 0.5;
+};
+
+struct Sugar {
+    static constexpr double cost = 0.25;
+};
+
+class Coffee {
+public:
+    virtual string getDescription() = 0;
+    virtual double getCost() = 0;
+    virtual ~Coffee() {}
+};
+
+class Mocha : public Coffee {
+public:
+    static constexpr double cost = 3.0;
+    string getDescription() override { return "Mocha"; }
+    double getCost() override { return cost; }
+};
+
+class Espresso : public Coffee {
+public:
+    static constexpr double cost = 4.5;
+    string getDescription() override { return "Espresso"; }
+    double getCost() override { return cost; }
+};
+
+class CoffeeDecorator : public Coffee {
+protected:
+    unique_ptr<Coffee> coffee;
+public:
+    CoffeeDecorator(unique_ptr<Coffee> coffee) : coffee(std::move(coffee)) {}
+};
+
+class MilkDecorator : public CoffeeDecorator {
+public:
+    MilkDecorator(unique_ptr<Coffee> coffee) : CoffeeDecorator(std::move(coffee)) {}
+    string getDescription() override { return coffee -> getDescription() + ", Milk"; }
+    double getCost() override { return coffee -> getCost() + Milk::cost; }
+};
+
+class SugarDecorator : public CoffeeDecorator {
+public:
+    SugarDecorator(unique_ptr<Coffee> coffee) : CoffeeDecorator(std::move(coffee)) {}
+    string getDescription() override { return coffee -> getDescription() + ", Sugar"; }
+    double getCost() override { return coffee -> getCost() + Sugar::cost; }
+};
+
+// --------- Columnar orders ---------
+enum Product : uint8_t { MOCHA, ESPRESSO, PRODUCT_COUNT };
+enum AddOn : uint8_t { MILK, SUGAR, ADDON_COUNT };
+
+struct OrderBatch {
+    vector<uint8_t> product;
+    vector<uint8_t> addOns[ADDON_COUNT];
+
+    size_t size() const { return product.size(); }
+
+    void add(Product p, uint8_t milk, uint8_t sugar) {
+        product.push_back(p);
+        addOns[MILK].push_back(milk);
+        addOns[SUGAR].push_back(sugar);
+    }
+};
+
+int32_t toCents(double dollars) {
+    return (int32_t)llround(dollars * 100);
+}
+
+// --------- Batch pricing engine ---------
+class BatchPricingEngine {
+private:
+    int32_t basePrice[PRODUCT_COUNT];       // cents
+    int32_t addOnPrice[ADDON_COUNT];        // cents
+    size_t parallelThreshold;
+    bool avx2 = false;
+
+    // prices orders [begin, end)
+    void priceScalar(const OrderBatch& orders, int32_t* totals, size_t begin, size_t end) const {
+        for (size_t i = begin; i < end; i++) {
+            int32_t total = basePrice[orders.product[i]];
+            for (int k = 0; k < ADDON_COUNT; k++) {
+                total += addOnPrice[k] * orders.addOns[k][i];
+            }
+            totals[i] = total;
+        }
+    }
+
+#ifdef HAVE_X86_KERNELS
+    __attribute__((target("avx2")))
+    void priceAvx2(const OrderBatch& orders, int32_t* totals, size_t begin, size_t end) const {
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&orders.product[i])));
+            __m256i total = _mm256_i32gather_epi32(basePrice, idx, 4);
+
+            for (int k = 0; k < ADDON_COUNT; k++) {
+                __m256i n = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&orders.addOns[k][i])));
+                total = _mm256_add_epi32(total, _mm256_mullo_epi32(n, _mm256_set1_epi32(addOnPrice[k])));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(totals + i), total);
+        }
+        priceScalar(orders, totals, i, end);
+    }
+#endif
+
+    void priceRange(const OrderBatch& orders, int32_t* totals, size_t begin, size_t end) const {
+#ifdef HAVE_X86_KERNELS
+        if (avx2) {
+            priceAvx2(orders, totals, begin, end);
+            return;
+        }
+#endif
+        priceScalar(orders, totals, begin, end);
+    }
+
+    // the gather reads basePrice[product[i]] unchecked
+    static void validate(const OrderBatch& orders) {
+        for (int k = 0; k < ADDON_COUNT; k++) {
+            if (orders.addOns[k].size() != orders.size()) throw invalid_argument("add-on column length differs from the batch");
+        }
+        for (size_t i = 0; i < orders.size(); i++) {
+            if (orders.product[i] >= PRODUCT_COUNT) {
+                throw out_of_range("unknown product " + to_string(orders.product[i]) + " on order " + to_string(i));
+            }
+        }
+    }
+
+public:
+    BatchPricingEngine(size_t parallelThreshold = 1 << 16) : parallelThreshold(parallelThreshold) {
+        // the same price list the decorators use
+        basePrice[MOCHA] = toCents(Mocha::cost);
+        basePrice[ESPRESSO] = toCents(Espresso::cost);
+        addOnPrice[MILK] = toCents(Milk::cost);
+        addOnPrice[SUGAR] = toCents(Sugar::cost);
+
+        // the largest possible order must still fit in int32 cents
+        int64_t worst = 0;
+        for (int32_t p : basePrice) worst = max<int64_t>(worst, p);
+        for (int32_t p : addOnPrice) worst += (int64_t)p * UINT8_MAX;
+        if (worst > INT32_MAX) throw overflow_error("menu prices too large for int32 cents");
+
+#ifdef HAVE_X86_KERNELS
+        avx2 = __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    const char* kernel() const { return avx2 ? "AVX2" : "scalar"; }
+
+    // totals in cents, throws on unknown products or ragged columns
+    vector<int32_t> price(const OrderBatch& orders) const {
+        validate(orders);
+        vector<int32_t> totals(orders.size());
+        size_t n = orders.size();
+        size_t workers = max(1u, thread::hardware_concurrency());
+
+        if (n < parallelThreshold || workers == 1) {
+            priceRange(orders, totals.data(), 0, n);
+            return totals;
+        }
+
+        // chunks are multiples of 8 so only the last one has a scalar tail
+        size_t chunk = ((n + workers - 1) / workers + 7) & ~(size_t)7;
+        vector<thread> threads;
+        for (size_t begin = 0; begin < n; begin += chunk) {
+            size_t end = min(n, begin + chunk);
+            threads.emplace_back([&, begin, end] { priceRange(orders, totals.data(), begin, end); });
+        }
+        for (auto& t : threads) t.join();
+        return totals;
+    }
+};
+
+// --------- Helpers ---------
+unique_ptr<Coffee> buildCoffee(Product p, int milk, int sugar) {
+    unique_ptr<Coffee> coffee;
+    if (p == MOCHA) coffee = make_unique<Mocha>();
+    else coffee = make_unique<Espresso>();
+
+    for (int i = 0; i < milk; i++) coffee = make_unique<MilkDecorator>(std::move(coffee));
+    for (int i = 0; i < sugar; i++) coffee = make_unique<SugarDecorator>(std::move(coffee));
+    return coffee;
+}
+
+double secondsSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+int main() {
+    const size_t N = 1'000'000;
+    mt19937 g(7);
+
+    OrderBatch orders;
+    vector<unique_ptr<Coffee>> objects;
+    objects.reserve(N);
+    for (size_t i = 0; i < N; i++) {
+        Product p = Product(g() % PRODUCT_COUNT);
+        uint8_t milk = g() % 3, sugar = g() % 4;
+        orders.add(p, milk, sugar);
+        objects.push_back(buildCoffee(p, milk, sugar));
+    }
+
+    // object graph path
+    auto t0 = chrono::steady_clock::now();
+    vector<double> expected(N);
+    for (size_t i = 0; i < N; i++) expected[i] = objects[i] -> getCost();
+    double objectSecs = secondsSince(t0);
+
+    // batch path
+    BatchPricingEngine engine;
+    t0 = chrono::steady_clock::now();
+    vector<int32_t> totals = engine.price(orders);
+    double batchSecs = secondsSince(t0);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < N; i++) mismatches += (totals[i] != toCents(expected[i]));
+
+    // a corrupt product ID is rejected before it can index the price table
+    OrderBatch corrupt = orders;
+    corrupt.product[N / 2] = 200;
+    try {
+        engine.price(corrupt);
+    }
+    catch (const out_of_range& e) {
+        cout << "rejected: " << e.what() << endl;
+    }
+
+    cout << "kernel: " << engine.kernel() << endl;
+    cout << "orders: " << N << ", mismatches: " << mismatches << endl;
+    cout << "object graph: " << (long)(N / objectSecs / 1e6) << " M orders/sec" << endl;
+    cout << "batch engine: " << (long)(N / batchSecs / 1e6) << " M orders/sec" << endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 using namespace std;
 
 /*
@@ -12,8 +13,51 @@ using namespace std;
     It provides a flexible alternative to 
     subclassing for extending functionality.
     Open/Closed principle
+
+    Every getCost() walks the whole unique_ptr chain through one
+    virtual call per layer, and every getDescription() builds a new
+    string per layer. Two ways to price a menu item with a load:
+    - Decorated<Espresso, Milk, Sugar> folds cost and description
+      at compile time when the chain is known up front
+    - flatten() collapses a chain built at runtime into one
+      precomputed FlatCoffee node
 */
 
+// compile-time string, so descriptions can be concatenated in constexpr
+template <size_t N>
+struct FixedString {
+    char data[N + 1] = {};
+
+    constexpr FixedString() = default;
+    constexpr FixedString(const char (&str)[N + 1]) {
+        for (size_t i = 0; i < N; i++) data[i] = str[i];
+    }
+
+    constexpr string_view view() const { return string_view(data, N); }
+};
+
+template <size_t N>
+FixedString(const char (&)[N]) -> FixedString<N - 1>;
+
+template <size_t A, size_t B>
+constexpr FixedString<A + B> operator+(const FixedString<A>& a, const FixedString<B>& b) {
+    FixedString<A + B> out;
+    for (size_t i = 0; i < A; i++) out.data[i] = a.data[i];
+    for (size_t i = 0; i < B; i++) out.data[A + i] = b.data[i];
+    return out;
+}
+
+// add-on price list, shared by the runtime and the compile-time decorators
+struct Milk {
+    static constexpr FixedString name{", Milk"};
+    static constexpr double cost = 0.5;
+};
+
+struct Sugar {
+    static constexpr FixedString name{", Sugar"};
+    static constexpr double cost = 0.25;
+};
+
 class Coffee {
 public:
     virtual string getDescription() = 0;
@@ -23,22 +67,28 @@ public:
 
 class Mocha : public Coffee {
 public:
+    static constexpr FixedString name{"Mocha"};
+    static constexpr double cost = 3.0;
+
     string getDescription() override {
-        return "Mocha";
+        return string(name.view());
     }
 
     double getCost() override {
-        return 3.0;
+        return cost;
     }
 };
 
 class Espresso : public Coffee {
 public:
+    static constexpr FixedString name{"Espresso"};
+    static constexpr double cost = 4.5;
+
     string getDescription() override {
-        return "Espresso";
+        return string(name.view());
     }
     double getCost() override {
-        return 4.5;
+        return cost;
     }
 };
 
@@ -64,11 +114,11 @@ public:
     MilkDecorator(unique_ptr<Coffee> coffee) : CoffeeDecorator(std::move(coffee)) {}
 
     string getDescription() override {
-        return coffee -> getDescription() + ", Milk";
+        return coffee -> getDescription() + string(Milk::name.view());
     }
 
     double getCost() override {
-        return coffee -> getCost() + 0.5;
+        return coffee -> getCost() + Milk::cost;
     }
 };
 
@@ -77,14 +127,56 @@ public:
     SugarDecorator(unique_ptr<Coffee> coffee) : CoffeeDecorator(std::move(coffee)) {}
 
     string getDescription() override {
-        return coffee -> getDescription() + ", Sugar";
+        return coffee -> getDescription() + string(Sugar::name.view());
     }
 
     double getCost() override {
-        return coffee -> getCost() + 0.25;
+        return coffee -> getCost() + Sugar::cost;
     }
 };
 
+// --------- Compile-time decorator chain ---------
+// the left folds add in the same order as the nested decorators,
+// so the cost is bit-identical to the runtime chain
+template <typename Base, typename... AddOns>
+class Decorated : public Coffee {
+public:
+    static constexpr auto name = (Base::name + ... + AddOns::name);
+    static constexpr double cost = (Base::cost + ... + AddOns::cost);
+
+    string getDescription() override {
+        return string(name.view());
+    }
+
+    double getCost() override {
+        return cost;
+    }
+};
+
+// --------- Flattened runtime chain ---------
+class FlatCoffee : public Coffee {
+private:
+    string description;
+    double cost;
+public:
+    FlatCoffee(string description, double cost) : description(std::move(description)), cost(cost) {}
+
+    const string& describe() const { return description; }  // no copy
+
+    string getDescription() override {
+        return description;
+    }
+
+    double getCost() override {
+        return cost;
+    }
+};
+
+// walks the chain once, every later call is a load
+unique_ptr<Coffee> flatten(unique_ptr<Coffee> coffee) {
+    return make_unique<FlatCoffee>(coffee -> getDescription(), coffee -> getCost());
+}
+
 int main() {
     // Coffee shop
 
@@ -106,6 +198,20 @@ int main() {
 
     cout << "Order " + espressoCoffee -> getDescription() << endl;
     cout << "Total Cost: $" + to_string(espressoCoffee -> getCost()) << endl;
-    
+
+    // same order, resolved at compile time
+    using EspressoMilkSugar = Decorated<Espresso, Milk, Sugar>;
+    static_assert(EspressoMilkSugar::cost == 5.25);
+    static_assert(EspressoMilkSugar::name.view() == "Espresso, Milk, Sugar");
+
+    unique_ptr<Coffee> menuItem = make_unique<EspressoMilkSugar>();
+    cout << "Order " + menuItem -> getDescription() << endl;
+    cout << "Total Cost: $" + to_string(menuItem -> getCost()) << endl;
+
+    // chain configured at runtime, collapsed into one node
+    unique_ptr<Coffee> flatMocha = flatten(std::move(mochaCoffee));
+    cout << "Order " + flatMocha -> getDescription() << endl;
+    cout << "Total Cost: $" + to_string(flatMocha -> getCost()) << endl;
+
     return 0;
 }
\ No newline at end of file
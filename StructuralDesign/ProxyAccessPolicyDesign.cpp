@@ -0,0 +1,335 @@
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <bitset>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <string_view>
+using namespace std;
+
+/*
+    Why a policy engine for content rights?
+    ProxyDesign.cpp hardcodes one rule:
+        userType != "Premium" && beginWith(videoName, "Premium")
+    We need hundreds of tiers and many prefix / tag rules.
+
+    Rules are compiled into an immutable CompiledPolicy:
+    - prefix rules live in a trie flattened into arrays (nodes with
+      a sorted edge range), the longest matching prefix decides
+    - tag rules are a table indexed by tag ID
+    - every rule holds the set of tiers it allows as a bitset, and
+      every user holds the tiers they have, so a rule check is one
+      bitset intersection
+    A decision is one walk over the video name with no allocations.
+
+    PolicyEngine publishes a CompiledPolicy through an atomic pointer.
+    Readers enter a two-slot epoch and never block; a reload swaps
+    the pointer, waits until the readers of the old epoch have left
+    and only then frees the old policy.
+*/
+
+constexpr size_t MAX_TIERS = 512;
+using TierSet = bitset<MAX_TIERS>;
+
+TierSet tiers(initializer_list<int> ids) {
+    TierSet t;
+    for (int id : ids) t.set(id);
+    return t;
+}
+
+// --------- Compiled policy ---------
+class CompiledPolicy {
+private:
+    struct Node {
+        uint32_t firstEdge;
+        uint16_t edgeCount;
+        int32_t rule;           // -1 when no prefix ends here
+    };
+
+    struct Edge {
+        char label;
+        uint32_t child;
+    };
+
+    vector<Node> nodes;
+    vector<Edge> edges;
+    vector<TierSet> rules;      // allowed tiers per prefix rule
+    vector<TierSet> tagRules;   // allowed tiers per tag ID, all set when unrestricted
+    TierSet defaultAllowed;
+
+    friend class PolicyBuilder;
+
+    const Node* child(const Node& node, char c) const {
+        const Edge* begin = edges.data() + node.firstEdge;
+        const Edge* end = begin + node.edgeCount;
+        const Edge* it = lower_bound(begin, end, c, [](const Edge& e, char x) { return e.label < x; });
+        return (it != end && it -> label == c) ? &nodes[it -> child] : nullptr;
+    }
+public:
+    uint64_t version = 0;
+
+    // tags is a bitmask of tag IDs attached to the video
+    bool allows(const TierSet& user, string_view videoName, uint64_t tags = 0) const {
+        const TierSet* decision = &defaultAllowed;
+        const Node* node = &nodes[0];
+        if (node -> rule >= 0) decision = &rules[node -> rule];
+        for (char c : videoName) {
+            node = child(*node, c);
+            if (!node) break;
+            if (node -> rule >= 0) decision = &rules[node -> rule];
+        }
+        if ((*decision & user).none()) return false;
+
+        while (tags) {
+            int tag = __builtin_ctzll(tags);
+            tags &= tags - 1;
+            if (tag < (int)tagRules.size() && (tagRules[tag] & user).none()) return false;
+        }
+        return true;
+    }
+
+    size_t nodeCount() const { return nodes.size(); }
+};
+
+class PolicyBuilder {
+private:
+    struct BuildNode {
+        unordered_map<char, int> children;
+        int rule = -1;
+    };
+
+    vector<BuildNode> trie{1};
+    vector<TierSet> rules;
+    vector<TierSet> tagRules;
+    TierSet defaultAllowed;
+public:
+    PolicyBuilder() { defaultAllowed.set(); }   // no rule: everyone
+
+    PolicyBuilder& prefix(const string& prefix, const TierSet& allowed) {
+        int node = 0;
+        for (char c : prefix) {
+            auto it = trie[node].children.find(c);
+            if (it == trie[node].children.end()) {
+                trie.emplace_back();
+                it = trie[node].children.emplace(c, (int)trie.size() - 1).first;
+            }
+            node = it -> second;
+        }
+        if (trie[node].rule < 0) {
+            trie[node].rule = (int)rules.size();
+            rules.push_back(allowed);
+        }
+        else {
+            rules[trie[node].rule] = allowed;
+        }
+        return *this;
+    }
+
+    PolicyBuilder& tag(int tagId, const TierSet& allowed) {
+        if (tagId < 0 || tagId >= 64) throw out_of_range("tag IDs are 0-63");
+        if ((int)tagRules.size() <= tagId) tagRules.resize(tagId + 1, TierSet().set());
+        tagRules[tagId] = allowed;
+        return *this;
+    }
+
+    PolicyBuilder& fallback(const TierSet& allowed) {
+        defaultAllowed = allowed;
+        return *this;
+    }
+
+    // breadth-first so every node's edges are contiguous and sorted
+    unique_ptr<CompiledPolicy> compile() const {
+        auto policy = make_unique<CompiledPolicy>();
+        policy -> rules = rules;
+        policy -> tagRules = tagRules;
+        policy -> defaultAllowed = defaultAllowed;
+        policy -> nodes.resize(trie.size());
+
+        vector<int> order{0};
+        vector<uint32_t> compiledId(trie.size());
+        for (size_t head = 0; head < order.size(); head++) {
+            int id = order[head];
+            compiledId[id] = (uint32_t)head;
+            vector<pair<char, int>> kids(trie[id].children.begin(), trie[id].children.end());
+            sort(kids.begin(), kids.end());
+            for (auto& kid : kids) order.push_back(kid.second);
+        }
+        for (size_t head = 0; head < order.size(); head++) {
+            const BuildNode& b = trie[order[head]];
+            vector<pair<char, int>> kids(b.children.begin(), b.children.end());
+            sort(kids.begin(), kids.end());
+            auto& node = policy -> nodes[head];
+            node.firstEdge = (uint32_t)policy -> edges.size();
+            node.edgeCount = (uint16_t)kids.size();
+            node.rule = b.rule;
+            for (auto& [c, kid] : kids) policy -> edges.push_back({c, compiledId[kid]});
+        }
+        return policy;
+    }
+};
+
+// --------- Hot-reloadable engine ---------
+class PolicyEngine {
+private:
+    atomic<const CompiledPolicy*> current;
+    atomic<uint64_t> epoch{0};
+    atomic<long> readers[2] = {0, 0};
+    mutex writer;
+    uint64_t versions = 0;
+public:
+    PolicyEngine(unique_ptr<CompiledPolicy> initial) {
+        initial -> version = ++versions;
+        current.store(initial.release());
+    }
+
+    ~PolicyEngine() { delete current.load(); }
+
+    // readers never wait: enter the current epoch, read, leave
+    // (seq_cst: the reader's count/epoch and the writer's epoch/count must not reorder)
+    bool allows(const TierSet& user, string_view videoName, uint64_t tags = 0) {
+        uint64_t e;
+        while (true) {
+            e = epoch.load();
+            readers[e & 1].fetch_add(1);
+            if (epoch.load() == e) break;
+            readers[e & 1].fetch_sub(1, memory_order_release);     // reload raced us, retry
+        }
+        bool allowed = current.load(memory_order_acquire) -> allows(user, videoName, tags);
+        readers[e & 1].fetch_sub(1, memory_order_release);
+        return allowed;
+    }
+
+    // publishes the new policy, frees the old one after its readers drained
+    void reload(unique_ptr<CompiledPolicy> next) {
+        lock_guard<mutex> guard(writer);
+        next -> version = ++versions;
+        const CompiledPolicy* old = current.exchange(next.release());
+        uint64_t e = epoch.fetch_add(1);
+        while (readers[e & 1].load() != 0) this_thread::yield();
+        delete old;
+    }
+
+    uint64_t version() const { return versions; }
+};
+
+// --------- Proxy ---------
+class VideoService {
+public:
+    virtual void playVideo(string userType, string videoName) = 0;
+    virtual ~VideoService() {}
+};
+
+class RealVideoService : public VideoService {
+public:
+    void playVideo(string, string videoName) override {
+        cout << "Streaming Video: " + videoName << endl;
+    }
+};
+
+class ProxyVideoService : public VideoService {
+private:
+    unique_ptr<RealVideoService> realVideoService;
+    PolicyEngine& policy;
+    unordered_map<string, TierSet> userTiers;   // user type -> tiers
+public:
+    ProxyVideoService(unique_ptr<RealVideoService> rvs, PolicyEngine& policy)
+        : realVideoService(std::move(rvs)), policy(policy) {}
+
+    void setTiers(const string& userType, const TierSet& t) { userTiers[userType] = t; }
+
+    void playVideo(string userType, string videoName) override {
+        // user content rights validation
+        auto it = userTiers.find(userType);
+        if (it == userTiers.end() || !policy.allows(it -> second, videoName)) {
+            cout << "Access Denied: Subscribe to access premium content." << endl;
+            return;
+        }
+        realVideoService -> playVideo(userType, videoName);
+    }
+};
+
+// --------- Benchmark ---------
+unique_ptr<CompiledPolicy> randomPolicy(mt19937& g, int prefixRules, int tierCount) {
+    PolicyBuilder builder;
+    for (int i = 0; i < prefixRules; i++) {
+        TierSet allowed;
+        for (int k = 0; k < 8; k++) allowed.set(g() % tierCount);
+        builder.prefix("Show " + to_string(i % 500) + "/S" + to_string(i / 500), allowed);
+    }
+    builder.tag(0, tiers({0, 1, 2}));   // e.g. "explicit"
+    return builder.compile();
+}
+
+int main() {
+    enum Tier { FREE, PREMIUM, FAMILY };
+
+    PolicyEngine engine(PolicyBuilder()
+        .prefix("Premium", tiers({PREMIUM, FAMILY}))
+        .prefix("Premium Trailer", tiers({FREE, PREMIUM, FAMILY}))
+        .compile());
+
+    ProxyVideoService proxyService(make_unique<RealVideoService>(), engine);
+    proxyService.setTiers("Free", tiers({FREE}));
+    proxyService.setTiers("Premium", tiers({PREMIUM}));
+
+    proxyService.playVideo("Free", "Free Video 1");
+    proxyService.playVideo("Premium", "Premium Video 1");
+    proxyService.playVideo("Free", "Premium Video 1");
+    proxyService.playVideo("Free", "Premium Trailer 1");    // longer prefix wins
+
+    // new rules go live without stopping checks
+    engine.reload(PolicyBuilder().prefix("Premium", tiers({FREE, PREMIUM})).compile());
+    proxyService.playVideo("Free", "Premium Video 1");
+
+    cout << "\n--- 300 tiers, 20k prefix rules, reloads running in the background ---" << endl;
+    mt19937 g(5);
+    const int tierCount = 300;
+    engine.reload(randomPolicy(g, 20000, tierCount));
+
+    vector<string> names;
+    vector<TierSet> users;
+    for (int i = 0; i < 4096; i++) {
+        names.push_back("Show " + to_string(g() % 600) + "/S" + to_string(g() % 50) + "/E" + to_string(g() % 20));
+        TierSet t;
+        for (int k = 0; k < 3; k++) t.set(g() % tierCount);
+        users.push_back(t);
+    }
+
+    auto run = [&](const string& label) {
+        const long checks = 5'000'000;
+        long allowed = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (long i = 0; i < checks; i++) {
+            allowed += engine.allows(users[i & 4095], names[(i * 7) & 4095], i & 1);
+        }
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        cout << label << ": " << (long)(checks / secs / 1e6) << " M checks/sec, "
+             << (100 * allowed / checks) << "% allowed" << endl;
+    };
+
+    run("steady policy ");
+
+    // a new policy every 10 ms while the checks run
+    atomic<bool> stop{false};
+    uint64_t before = engine.version();
+    thread reloader([&] {
+        mt19937 rg(9);
+        while (!stop.load()) {
+            auto next = randomPolicy(rg, 20000, tierCount);
+            engine.reload(std::move(next));
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+    });
+    run("during reloads");
+    stop = true;
+    reloader.join();
+    cout << (engine.version() - before) << " policy versions published during the run" << endl;
+
+    return 0;
+}
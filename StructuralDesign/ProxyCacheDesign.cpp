@@ -0,0 +1,440 @@
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <string>
+using namespace std;
+
+/*
+    Why a bounded cache in the Proxy?
+    ProxyDesign.cpp caches every video ever requested in an
+    unordered_map that never evicts, so memory grows with every
+    distinct video.
+
+    VideoCache replaces it with a cache tier that has
+    - a byte budget, each entry is charged its video size
+    - an eviction policy picked at construction (Strategy pattern)
+        LRU        list + map, evicts the least recently used
+        CLOCK      ring of reference bits, second chance eviction
+        W-TinyLFU  small LRU window + segmented LRU main area,
+                   admission decided by a count-min frequency sketch
+    - an optional per-entry TTL, expired entries count as misses
+    - hit / miss / eviction / expiration counters
+
+    All operations are O(1) (CLOCK amortized O(1)).
+*/
+
+using Clock = chrono::steady_clock;
+
+// --------- Eviction policies ---------
+class EvictionPolicy {
+public:
+    virtual void onInsert(const string& key) = 0;
+    virtual void onAccess(const string& key) = 0;
+    virtual void onErase(const string& key) = 0;
+    virtual string victim() = 0;    // key to evict next, cache is not empty
+    virtual ~EvictionPolicy() {}
+};
+
+class LRUPolicy : public EvictionPolicy {
+private:
+    list<string> order;     // front = most recent
+    unordered_map<string, list<string>::iterator> position;
+public:
+    void onInsert(const string& key) override {
+        order.push_front(key);
+        position[key] = order.begin();
+    }
+
+    void onAccess(const string& key) override {
+        order.splice(order.begin(), order, position.at(key));
+    }
+
+    void onErase(const string& key) override {
+        auto it = position.find(key);
+        if (it == position.end()) return;
+        order.erase(it -> second);
+        position.erase(it);
+    }
+
+    string victim() override {
+        return order.back();
+    }
+};
+
+class ClockPolicy : public EvictionPolicy {
+private:
+    struct Slot {
+        string key;
+        bool referenced = false;
+        bool used = false;
+    };
+
+    vector<Slot> ring;
+    vector<size_t> freeSlots;
+    unordered_map<string, size_t> slotOf;
+    size_t hand = 0;
+public:
+    void onInsert(const string& key) override {
+        size_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            slot = ring.size();
+            ring.emplace_back();
+        }
+        ring[slot] = Slot{key, false, true};
+        slotOf[key] = slot;
+    }
+
+    void onAccess(const string& key) override {
+        ring[slotOf.at(key)].referenced = true;
+    }
+
+    void onErase(const string& key) override {
+        auto it = slotOf.find(key);
+        if (it == slotOf.end()) return;
+        ring[it -> second] = Slot{};
+        freeSlots.push_back(it -> second);
+        slotOf.erase(it);
+    }
+
+    // give referenced slots a second chance, stop at the first cold one
+    string victim() override {
+        while (true) {
+            Slot& slot = ring[hand];
+            hand = (hand + 1) % ring.size();
+            if (!slot.used) continue;
+            if (slot.referenced) slot.referenced = false;
+            else return slot.key;
+        }
+    }
+};
+
+// 4 rows of 8-bit counters, halved after every sampleSize increments
+class FrequencySketch {
+private:
+    static constexpr int DEPTH = 4;
+    vector<uint8_t> table[DEPTH];
+    size_t mask;
+    size_t additions = 0;
+    size_t sampleSize;
+
+    size_t index(size_t h, int row) const {
+        h ^= (h >> 17) * (0x9E3779B97F4A7C15ULL + row * 0x632BE59BD9B4E019ULL);
+        return (h * (row + 1) + (h >> 29)) & mask;
+    }
+public:
+    FrequencySketch(size_t width = 1 << 14) {
+        size_t w = 1;
+        while (w < width) w <<= 1;
+        mask = w - 1;
+        sampleSize = w * 10;
+        for (auto& row : table) row.assign(w, 0);
+    }
+
+    void increment(const string& key) {
+        size_t h = hash<string>{}(key);
+        for (int r = 0; r < DEPTH; r++) {
+            uint8_t& c = table[r][index(h, r)];
+            if (c < 255) c++;
+        }
+        if (++additions >= sampleSize) {    // aging keeps the sketch fresh
+            for (auto& row : table) for (auto& c : row) c >>= 1;
+            additions /= 2;
+        }
+    }
+
+    int frequency(const string& key) const {
+        size_t h = hash<string>{}(key);
+        int f = 255;
+        for (int r = 0; r < DEPTH; r++) f = min<int>(f, table[r][index(h, r)]);
+        return f;
+    }
+};
+
+class WTinyLFUPolicy : public EvictionPolicy {
+private:
+    enum Area { WINDOW, PROBATION, PROTECTED };
+
+    list<string> areas[3];      // front = most recent
+    unordered_map<string, pair<Area, list<string>::iterator>> position;
+    FrequencySketch sketch;
+    double windowShare;
+    double protectedShare;
+    string candidate;           // last entry pushed out of the window
+    bool hasCandidate = false;
+
+    void moveTo(const string& key, Area area) {
+        auto& [current, it] = position.at(key);
+        areas[area].splice(areas[area].begin(), areas[current], it);
+        current = area;
+    }
+
+    size_t mainSize() const { return areas[PROBATION].size() + areas[PROTECTED].size(); }
+public:
+    WTinyLFUPolicy(double windowShare = 0.01, double protectedShare = 0.8)
+        : windowShare(windowShare), protectedShare(protectedShare) {}
+
+    void onInsert(const string& key) override {
+        sketch.increment(key);
+        areas[WINDOW].push_front(key);
+        position[key] = {WINDOW, areas[WINDOW].begin()};
+
+        // window overflow moves its LRU entry to probation as the admission candidate
+        size_t windowLimit = max<size_t>(1, (size_t)ceil(position.size() * windowShare));
+        if (areas[WINDOW].size() > windowLimit) {
+            candidate = areas[WINDOW].back();
+            hasCandidate = true;
+            moveTo(candidate, PROBATION);
+        }
+    }
+
+    void onAccess(const string& key) override {
+        sketch.increment(key);
+        Area area = position.at(key).first;
+        if (area == PROBATION) {
+            if (hasCandidate && key == candidate) hasCandidate = false;
+            moveTo(key, PROTECTED);
+            // keep the protected segment within its share of the main area
+            if (areas[PROTECTED].size() > max<size_t>(1, (size_t)(mainSize() * protectedShare))) {
+                moveTo(areas[PROTECTED].back(), PROBATION);
+            }
+        }
+        else {
+            moveTo(key, area);
+        }
+    }
+
+    void onErase(const string& key) override {
+        auto it = position.find(key);
+        if (it == position.end()) return;
+        if (hasCandidate && key == candidate) hasCandidate = false;
+        areas[it -> second.first].erase(it -> second.second);
+        position.erase(it);
+    }
+
+    // the candidate competes with probation's LRU entry, the less frequent one goes
+    string victim() override {
+        if (!areas[PROBATION].empty()) {
+            const string& incumbent = areas[PROBATION].back();
+            if (hasCandidate && candidate != incumbent &&
+                sketch.frequency(candidate) <= sketch.frequency(incumbent)) {
+                return candidate;
+            }
+            return incumbent;
+        }
+        if (!areas[PROTECTED].empty()) return areas[PROTECTED].back();
+        return areas[WINDOW].back();
+    }
+};
+
+enum class PolicyType { LRU, CLOCK, W_TINY_LFU };
+
+unique_ptr<EvictionPolicy> makePolicy(PolicyType type) {
+    switch (type) {
+        case PolicyType::LRU: return make_unique<LRUPolicy>();
+        case PolicyType::CLOCK: return make_unique<ClockPolicy>();
+        case PolicyType::W_TINY_LFU: return make_unique<WTinyLFUPolicy>();
+    }
+    throw runtime_error("Invalid policy type");
+}
+
+// --------- Cache ---------
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t expirations = 0;
+};
+
+class VideoCache {
+private:
+    struct Entry {
+        string value;
+        size_t bytes;
+        Clock::time_point expiresAt;    // max() means no TTL
+    };
+
+    unordered_map<string, Entry> entries;
+    unique_ptr<EvictionPolicy> policy;
+    size_t capacityBytes;
+    size_t usedBytes = 0;
+    CacheStats stats;
+
+    void erase(unordered_map<string, Entry>::iterator it) {
+        usedBytes -= it -> second.bytes;
+        policy -> onErase(it -> first);
+        entries.erase(it);
+    }
+public:
+    VideoCache(size_t capacityBytes, PolicyType type)
+        : policy(makePolicy(type)), capacityBytes(capacityBytes) {}
+
+    const string* get(const string& key) {
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            stats.misses++;
+            return nullptr;
+        }
+        if (Clock::now() >= it -> second.expiresAt) {
+            erase(it);
+            stats.expirations++;
+            stats.misses++;
+            return nullptr;
+        }
+        policy -> onAccess(key);
+        stats.hits++;
+        return &it -> second.value;
+    }
+
+    // ttl of zero keeps the entry until it is evicted
+    bool put(const string& key, string value, size_t bytes, chrono::milliseconds ttl = chrono::milliseconds(0)) {
+        if (bytes > capacityBytes) return false;    // would flush everything else
+
+        auto existing = entries.find(key);
+        if (existing != entries.end()) erase(existing);
+
+        while (usedBytes + bytes > capacityBytes) {
+            erase(entries.find(policy -> victim()));
+            stats.evictions++;
+        }
+
+        auto expiresAt = ttl.count() > 0 ? Clock::now() + ttl : Clock::time_point::max();
+        entries.emplace(key, Entry{std::move(value), bytes, expiresAt});
+        policy -> onInsert(key);
+        usedBytes += bytes;
+        return true;
+    }
+
+    const CacheStats& getStats() const { return stats; }
+    size_t size() const { return entries.size(); }
+    size_t bytes() const { return usedBytes; }
+};
+
+// --------- Proxy ---------
+bool beginWith(const string& a, const string& b) {
+    return a.compare(0, b.size(), b) == 0;
+}
+
+class VideoService {
+public:
+    virtual void playVideo(string userType, string videoName) = 0;
+    virtual ~VideoService() {}
+};
+
+class RealVideoService : public VideoService {
+public:
+    void playVideo(string, string videoName) override {
+        cout << "Streaming Video: " + videoName << endl;
+    }
+
+    // catalog metadata, stands in for the real file size
+    size_t videoSize(const string& videoName) const {
+        return (1 + hash<string>{}(videoName) % 8) << 20;     // 1 - 8 MB
+    }
+};
+
+class ProxyVideoService : public VideoService {
+private:
+    unique_ptr<RealVideoService> realVideoService;
+    unordered_map<string, int> requestCounts;
+    VideoCache cachedVideos;
+    chrono::milliseconds ttl;
+public:
+    ProxyVideoService(unique_ptr<RealVideoService> rvs, size_t cacheBytes, PolicyType policy,
+                      chrono::milliseconds ttl = chrono::milliseconds(0))
+        : realVideoService(std::move(rvs)), cachedVideos(cacheBytes, policy), ttl(ttl) {}
+
+    void playVideo(string userType, string videoName) override {
+        // user content rights validation
+        if (userType != "Premium" && beginWith(videoName, "Premium")) {
+            cout << "Access Denied: Subscribe to access premium content." << endl;
+            return;
+        }
+
+        // rate limitter
+        requestCounts[userType]++;
+        if (requestCounts[userType] > 5) {
+            cout << "Access Denied: Too many requests." << endl;
+            return;
+        }
+
+        // check video in cache
+        if (cachedVideos.get(videoName)) {
+            cout << "Streaming Cached Video: " + videoName << endl;
+        }
+        else {
+            realVideoService -> playVideo(userType, videoName);
+            cachedVideos.put(videoName, videoName, realVideoService -> videoSize(videoName), ttl);
+        }
+    }
+
+    const CacheStats& cacheStats() const { return cachedVideos.getStats(); }
+};
+
+// --------- Policy comparison ---------
+void compareHitRatios() {
+    const int catalog = 20000, requests = 300000;
+    const size_t budget = 2000 * 100;   // room for about 10% of the catalog
+
+    // Zipf(0.9) trace over the catalog
+    vector<double> cdf(catalog);
+    double sum = 0;
+    for (int i = 0; i < catalog; i++) cdf[i] = (sum += 1.0 / pow(i + 1, 0.9));
+    mt19937 g(1);
+    uniform_real_distribution<double> u(0, sum);
+    vector<string> trace(requests);
+    for (auto& key : trace) key = "video-" + to_string(lower_bound(cdf.begin(), cdf.end(), u(g)) - cdf.begin());
+
+    pair<PolicyType, string> policies[] = {
+        {PolicyType::LRU, "LRU"}, {PolicyType::CLOCK, "CLOCK"}, {PolicyType::W_TINY_LFU, "W-TinyLFU"}
+    };
+    for (auto& [type, name] : policies) {
+        VideoCache cache(budget, type);
+        for (auto& key : trace) {
+            if (!cache.get(key)) cache.put(key, key, 100);
+        }
+        auto& s = cache.getStats();
+        cout << name << ": hit ratio " << (100.0 * s.hits / requests) << "%, evictions " << s.evictions << endl;
+    }
+}
+
+int main() {
+    unique_ptr<RealVideoService> realService = make_unique<RealVideoService>();
+    unique_ptr<ProxyVideoService> proxyService =
+        make_unique<ProxyVideoService>(std::move(realService), 64 << 20, PolicyType::W_TINY_LFU);
+
+    proxyService -> playVideo("Free", "Free Video 1");
+    proxyService -> playVideo("Premium", "Premium Video 1");
+
+    proxyService -> playVideo("Free", "Premium Video 1");
+
+    for (int i = 0; i < 6; i++) {
+        proxyService -> playVideo("Free", "Free Video 1");
+    }
+
+    auto& s = proxyService -> cacheStats();
+    cout << "hits " << s.hits << ", misses " << s.misses << ", evictions " << s.evictions << endl;
+
+    // TTL: the entry expires and the next request goes to the real service
+    VideoCache shortLived(1 << 20, PolicyType::LRU);
+    shortLived.put("Trailer", "Trailer", 1024, chrono::milliseconds(10));
+    cout << "\nTrailer cached: " << (shortLived.get("Trailer") != nullptr) << endl;
+    this_thread::sleep_for(chrono::milliseconds(15));
+    cout << "Trailer cached after TTL: " << (shortLived.get("Trailer") != nullptr)
+         << ", expirations " << shortLived.getStats().expirations << endl;
+
+    cout << "\n--- Zipf trace, cache holds ~10% of the catalog ---" << endl;
+    compareHitRatios();
+
+    return 0;
+}
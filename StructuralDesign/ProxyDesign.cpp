@@ -20,10 +20,8 @@ using namespace std;
     ProxyVideoService is the proxy that controls access to RealVideoService
 */
 
-bool beginWith(string a, string b) {
-    auto it = a.find(b);
-    if (it != string::npos && it == (size_t)0) return true;
-    return false;
+bool beginWith(const string& a, const string& b) {
+    return a.compare(0, b.size(), b) == 0;   // prefix only, no scan
 }
 
 class VideoService {
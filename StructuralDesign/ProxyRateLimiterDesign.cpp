@@ -0,0 +1,415 @@
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <string>
+using namespace std;
+
+/*
+    Why a real rate limiter in the Proxy?
+    ProxyDesign.cpp limits with requestCounts[userType]++ > 5.
+    It is keyed by user type, not by user, and never resets,
+    so all Free users share one lifetime budget of 5 requests.
+
+    RateLimiter keys by user and supports three modes (Strategy):
+        TOKEN_BUCKET     capacity tokens, refilled at a fixed rate
+        SLIDING_COUNTER  current + weighted previous window count
+        SLIDING_LOG      timestamps of the last `limit` requests
+
+    Memory is fixed up front: a budget in bytes becomes a table of
+    slots, each slot is a 64-bit user hash plus one 64-bit packed
+    state word (the log mode adds `limit` timestamps per slot).
+    - checks are O(1): one bucket of 8 slots is probed
+    - the state word is updated with a CAS loop, no locks
+    - refill is computed lazily from the timestamp in the state
+    - when a bucket is full the user idle longest is evicted, but
+      only once their budget has fully recovered, so eviction loses
+      nothing; if every user in the bucket is still active the new
+      user is denied, since evicting an active user would hand them
+      a fresh budget when they come back
+*/
+
+using Clock = chrono::steady_clock;
+
+enum class RateLimitMode { TOKEN_BUCKET, SLIDING_COUNTER, SLIDING_LOG };
+
+struct RateLimitConfig {
+    RateLimitMode mode = RateLimitMode::TOKEN_BUCKET;
+    uint32_t limit = 5;                             // burst / requests per window
+    chrono::milliseconds window{1000};              // refill period of `limit` tokens
+    size_t memoryBudgetBytes = 64 << 20;
+};
+
+class RateLimiter {
+private:
+    static constexpr size_t BUCKET = 8;             // slots probed per user
+    static constexpr uint64_t TICK_US = 100;        // timestamps in 100us ticks
+    static constexpr uint64_t EVICTING = UINT64_MAX; // state while a slot changes owner
+
+    struct Slot {
+        atomic<uint64_t> user{0};                   // 0 = empty
+        atomic<uint64_t> state{0};
+    };
+
+    RateLimitConfig config;
+    size_t bucketMask;
+    unique_ptr<Slot[]> slots;
+    unique_ptr<atomic<uint32_t>[]> logs;            // SLIDING_LOG: `limit` ticks per slot
+    unique_ptr<atomic<bool>[]> logLocks;
+    uint64_t windowTicks;
+    Clock::time_point epoch = Clock::now();
+    atomic<uint64_t> evictions{0};
+    atomic<uint64_t> rejections{0};                 // denied because the bucket was all active users
+
+    enum Outcome { ALLOWED, DENIED, MOVED };        // MOVED: the slot was evicted, probe again
+
+    // ---- state word layouts ----
+    // TOKEN_BUCKET:     [ tick * limit at which the bucket is full again : 64 ]
+    // SLIDING_COUNTER:  [ window index : 32 | previous : 16 | current : 16 ]
+    // SLIDING_LOG:      [ last request tick : 48 | log head : 16 ]
+
+    static uint64_t hashUser(const string& userId) {
+        uint64_t h = hash<string>{}(userId);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h ? h : 1;
+    }
+
+    uint64_t lastSeen(uint64_t state) const {
+        switch (config.mode) {
+            case RateLimitMode::TOKEN_BUCKET: return state / config.limit;
+            case RateLimitMode::SLIDING_COUNTER: return (state >> 32) * windowTicks;
+            case RateLimitMode::SLIDING_LOG: return state >> 16;
+        }
+        return 0;
+    }
+
+    // the user's budget has fully recovered, a fresh slot would behave the same
+    bool idle(uint64_t state, uint64_t now) const {
+        if (state == 0) return true;
+        if (state == EVICTING) return false;
+        switch (config.mode) {
+            case RateLimitMode::TOKEN_BUCKET: return now * config.limit >= state;
+            case RateLimitMode::SLIDING_COUNTER: return now / windowTicks >= (state >> 32) + 2;
+            case RateLimitMode::SLIDING_LOG: return now >= lastSeen(state) + windowTicks;
+        }
+        return false;
+    }
+
+    // hands slot i from victim to user if it is still in the state we judged idle
+    bool tryEvict(size_t i, uint64_t victim, uint64_t seenState, uint64_t user) {
+        Slot& slot = slots[i];
+        if (config.mode == RateLimitMode::SLIDING_LOG) {
+            atomic<bool>& lock = logLocks[i];
+            while (lock.exchange(true, memory_order_acquire)) this_thread::yield();
+            bool unchanged = slot.user.load(memory_order_relaxed) == victim && slot.state.load(memory_order_relaxed) == seenState;
+            if (unchanged) {
+                slot.user.store(user, memory_order_relaxed);
+                slot.state.store(0, memory_order_relaxed);
+            }
+            lock.store(false, memory_order_release);
+            return unchanged;
+        }
+        // EVICTING fences off the victim's CAS loops until the new owner is in place
+        if (!slot.state.compare_exchange_strong(seenState, EVICTING, memory_order_acq_rel)) return false;
+        slot.user.store(user, memory_order_relaxed);
+        slot.state.store(0, memory_order_release);
+        return true;
+    }
+
+    // finds the user's slot, claiming an empty or the most idle one on a miss;
+    // SIZE_MAX when every slot of the bucket belongs to an active user
+    size_t slotFor(uint64_t user, uint64_t now) {
+        size_t base = (user & bucketMask) * BUCKET;
+        while (true) {
+            size_t oldest = SIZE_MAX;
+            uint64_t oldestSeen = UINT64_MAX, victim = 0, victimState = 0;
+
+            for (size_t i = base; i < base + BUCKET; i++) {
+                uint64_t current = slots[i].user.load(memory_order_acquire);
+                if (current == user) return i;
+                // an empty slot's state is still 0, nothing to reset
+                if (current == 0 && slots[i].user.compare_exchange_strong(current, user)) return i;
+                if (current == user) return i;      // lost the race to the same user
+                if (current == 0) continue;
+                uint64_t state = slots[i].state.load(memory_order_acquire);
+                if (idle(state, now) && lastSeen(state) < oldestSeen) {
+                    oldestSeen = lastSeen(state);
+                    oldest = i;
+                    victim = current;
+                    victimState = state;
+                }
+            }
+
+            if (oldest == SIZE_MAX) return SIZE_MAX;
+            if (tryEvict(oldest, victim, victimState, user)) {
+                evictions.fetch_add(1, memory_order_relaxed);
+                return oldest;
+            }
+            // someone else changed the slot first, look again
+        }
+    }
+
+    // ownership is checked after every state load: an evicted slot reads
+    // EVICTING or belongs to another user by the time the state changes
+    bool owns(Slot& slot, uint64_t user, uint64_t state) const {
+        return state != EVICTING && slot.user.load(memory_order_acquire) == user;
+    }
+
+    // token bucket kept as the time it is full again (GCRA), in units of
+    // tick / limit so a token is exactly windowTicks units and refill
+    // never rounds; a fresh slot (0) is full
+    Outcome tokenBucket(Slot& slot, uint64_t user, uint64_t now) {
+        const uint64_t scaledNow = now * config.limit;
+        const uint64_t burst = (uint64_t)(config.limit - 1) * windowTicks;
+        uint64_t state = slot.state.load(memory_order_acquire);
+        while (true) {
+            if (!owns(slot, user, state)) return MOVED;
+            uint64_t full = max(state, scaledNow);
+            if (full - scaledNow > burst) return DENIED;     // fewer than one token left
+            if (slot.state.compare_exchange_weak(state, full + windowTicks, memory_order_acq_rel)) return ALLOWED;
+        }
+    }
+
+    Outcome slidingCounter(Slot& slot, uint64_t user, uint64_t now) {
+        uint64_t state = slot.state.load(memory_order_acquire);
+        while (true) {
+            if (!owns(slot, user, state)) return MOVED;
+            uint64_t stateWindow = state >> 32;
+            uint64_t window = max(now / windowTicks, stateWindow);
+            uint64_t previous = (state >> 16) & 0xFFFF, current = state & 0xFFFF;
+            if (window == stateWindow + 1) {
+                previous = current;
+                current = 0;
+            }
+            else if (window != stateWindow) {
+                previous = current = 0;
+            }
+
+            // previous window weighted by how much of it still overlaps
+            uint64_t elapsed = now % windowTicks;
+            uint64_t estimate = previous * (windowTicks - elapsed) / windowTicks + current;
+            bool allowed = estimate < config.limit;
+            if (allowed) current++;
+            uint64_t next = (window << 32) | (previous << 16) | current;
+            if (slot.state.compare_exchange_weak(state, next, memory_order_acq_rel)) return allowed ? ALLOWED : DENIED;
+        }
+    }
+
+    Outcome slidingLog(size_t index, uint64_t user, uint64_t now) {
+        atomic<bool>& lock = logLocks[index];
+        while (lock.exchange(true, memory_order_acquire)) this_thread::yield();
+        if (slots[index].user.load(memory_order_relaxed) != user) {
+            lock.store(false, memory_order_release);
+            return MOVED;
+        }
+
+        // ring of the last `limit` request ticks, head is the oldest
+        atomic<uint32_t>* log = &logs[index * config.limit];
+        Slot& slot = slots[index];
+        uint64_t state = slot.state.load(memory_order_relaxed);
+        uint64_t last = state >> 16;
+        uint32_t head = (uint32_t)(state & 0xFFFF);
+        if (state == 0 || now - min(now, last) >= windowTicks) {
+            // every logged request is outside the window
+            for (uint32_t i = 0; i < config.limit; i++) log[i].store(0, memory_order_relaxed);
+            head = 0;
+        }
+
+        uint32_t oldest = log[head].load(memory_order_relaxed);
+        bool allowed = oldest == 0 || (uint32_t)now - oldest >= windowTicks;
+        if (allowed) {
+            log[head].store((uint32_t)now, memory_order_relaxed);
+            head = (head + 1) % config.limit;
+        }
+        slot.state.store((max(now, last) << 16) | head, memory_order_relaxed);
+
+        lock.store(false, memory_order_release);
+        return allowed ? ALLOWED : DENIED;
+    }
+
+public:
+    RateLimiter(RateLimitConfig config) : config(config) {
+        if (config.limit == 0 || config.limit > 0xFFFF) throw runtime_error("limit must be in [1, 65535]");
+
+        size_t bytesPerSlot = sizeof(Slot);
+        if (config.mode == RateLimitMode::SLIDING_LOG) bytesPerSlot += config.limit * sizeof(uint32_t) + 1;
+
+        size_t buckets = 1;
+        while (buckets * 2 * BUCKET * bytesPerSlot <= config.memoryBudgetBytes) buckets *= 2;
+        bucketMask = buckets - 1;
+        slots = make_unique<Slot[]>(buckets * BUCKET);
+        if (config.mode == RateLimitMode::SLIDING_LOG) {
+            logs = make_unique<atomic<uint32_t>[]>(buckets * BUCKET * config.limit);
+            logLocks = make_unique<atomic<bool>[]>(buckets * BUCKET);
+        }
+        windowTicks = max<uint64_t>(1, chrono::duration_cast<chrono::microseconds>(config.window).count() / TICK_US);
+    }
+
+    uint64_t ticks() const {
+        // start at 1 so a zero state always means a fresh slot
+        return 1 + chrono::duration_cast<chrono::microseconds>(Clock::now() - epoch).count() / TICK_US;
+    }
+
+    bool allow(const string& userId) {
+        return allow(hashUser(userId), ticks());
+    }
+
+    // hashed user and explicit time, for batch callers and tests
+    bool allow(uint64_t user, uint64_t now) {
+        while (true) {
+            size_t index = slotFor(user, now);
+            if (index == SIZE_MAX) {
+                rejections.fetch_add(1, memory_order_relaxed);
+                return false;
+            }
+            Outcome outcome = MOVED;
+            switch (config.mode) {
+                case RateLimitMode::TOKEN_BUCKET: outcome = tokenBucket(slots[index], user, now); break;
+                case RateLimitMode::SLIDING_COUNTER: outcome = slidingCounter(slots[index], user, now); break;
+                case RateLimitMode::SLIDING_LOG: outcome = slidingLog(index, user, now); break;
+            }
+            if (outcome != MOVED) return outcome == ALLOWED;
+        }
+    }
+
+    size_t capacity() const { return (bucketMask + 1) * BUCKET; }
+    uint64_t evictionCount() const { return evictions.load(); }
+    uint64_t rejectionCount() const { return rejections.load(); }
+    uint64_t windowLength() const { return windowTicks; }
+};
+
+// --------- Proxy ---------
+bool beginWith(const string& a, const string& b) {
+    return a.compare(0, b.size(), b) == 0;
+}
+
+class VideoService {
+public:
+    virtual void playVideo(string userId, string userType, string videoName) = 0;
+    virtual ~VideoService() {}
+};
+
+class RealVideoService : public VideoService {
+public:
+    void playVideo(string, string, string videoName) override {
+        cout << "Streaming Video: " + videoName << endl;
+    }
+};
+
+class ProxyVideoService : public VideoService {
+private:
+    unique_ptr<RealVideoService> realVideoService;
+    unordered_map<string, unique_ptr<RateLimiter>> rateLimiters;    // per user type
+    unordered_map<string, string> cachedVideos;
+public:
+    ProxyVideoService(unique_ptr<RealVideoService> rvs) : realVideoService(std::move(rvs)) {}
+
+    void setRateLimit(const string& userType, RateLimitConfig config) {
+        rateLimiters[userType] = make_unique<RateLimiter>(config);
+    }
+
+    void playVideo(string userId, string userType, string videoName) override {
+        // user content rights validation
+        if (userType != "Premium" && beginWith(videoName, "Premium")) {
+            cout << "Access Denied: Subscribe to access premium content." << endl;
+            return;
+        }
+
+        // rate limitter, user types without a limiter are unlimited
+        auto limiter = rateLimiters.find(userType);
+        if (limiter != rateLimiters.end() && !limiter -> second -> allow(userId)) {
+            cout << "Access Denied: Too many requests." << endl;
+            return;
+        }
+
+        // check video in cache
+        if (cachedVideos.find(videoName) != cachedVideos.end()) {
+            cout << "Streaming Cached Video: " + videoName << endl;
+        }
+        else {
+            realVideoService -> playVideo(userId, userType, videoName);
+            cachedVideos[videoName] = videoName;
+        }
+    }
+};
+
+// --------- Benchmark ---------
+void benchmark(RateLimitMode mode, const string& name) {
+    RateLimitConfig config;
+    config.mode = mode;
+    config.limit = mode == RateLimitMode::SLIDING_LOG ? 4 : 5;
+    config.memoryBudgetBytes = 64 << 20;
+    RateLimiter limiter(config);
+
+    const uint64_t users = 20'000'000, checks = 10'000'000;
+    uint64_t allowed = 0, now = 1, x = 88172645463325252ULL;
+
+    auto t0 = Clock::now();
+    for (uint64_t i = 0; i < checks; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;    // xorshift user picker
+        uint64_t user = (x % users) * 0x9E3779B97F4A7C15ULL | 1;
+        if ((i & 63) == 0) now++;                   // simulated time, 100us per 64 checks
+        allowed += limiter.allow(user, now);
+    }
+    double secs = chrono::duration<double>(Clock::now() - t0).count();
+
+    cout << name << ": " << (long)(checks / secs / 1e6) << " M checks/sec, "
+         << limiter.capacity() << " slots in " << (config.memoryBudgetBytes >> 20) << " MB, "
+         << limiter.evictionCount() << " evictions, " << limiter.rejectionCount() << " denied for lack of an idle slot, "
+         << (100 * allowed / checks) << "% allowed" << endl;
+}
+
+// one client polling every 5 ticks (0.5 ms), much faster than one token per 2000 ticks
+void pollFasterThanRefill() {
+    RateLimitConfig config;             // 5 per second
+    config.memoryBudgetBytes = 1 << 20;
+    RateLimiter limiter(config);
+    const uint64_t seconds = 20, user = 42;
+    uint64_t allowed = 0;
+    for (uint64_t now = 1; now <= seconds * limiter.windowLength(); now += 5) allowed += limiter.allow(user, now);
+    uint64_t expected = config.limit + seconds * config.limit;
+    cout << "polling every 0.5 ms for " << seconds << " s: " << allowed << " allowed, expected about "
+         << expected << (allowed + 1 >= expected && allowed <= expected ? " (ok)" : " (WRONG)") << endl;
+}
+
+int main() {
+    unique_ptr<RealVideoService> realService = make_unique<RealVideoService>();
+    unique_ptr<ProxyVideoService> proxyService = make_unique<ProxyVideoService>(std::move(realService));
+
+    RateLimitConfig freeTier;       // 5 requests per second, per user
+    freeTier.memoryBudgetBytes = 1 << 20;
+    proxyService -> setRateLimit("Free", freeTier);
+
+    proxyService -> playVideo("alice", "Free", "Free Video 1");
+    proxyService -> playVideo("pat", "Premium", "Premium Video 1");
+
+    proxyService -> playVideo("alice", "Free", "Premium Video 1");
+
+    for (int i = 0; i < 6; i++) {
+        proxyService -> playVideo("alice", "Free", "Free Video 1");
+    }
+
+    // another Free user has a budget of their own
+    proxyService -> playVideo("bob", "Free", "Free Video 1");
+
+    // the bucket refills lazily, no background thread
+    this_thread::sleep_for(chrono::milliseconds(250));
+    proxyService -> playVideo("alice", "Free", "Free Video 1");
+
+    cout << "\n--- refill under fast polling ---" << endl;
+    pollFasterThanRefill();
+
+    cout << "\n--- 20M users, 10M checks, 64 MB budget ---" << endl;
+    benchmark(RateLimitMode::TOKEN_BUCKET, "token bucket");
+    benchmark(RateLimitMode::SLIDING_COUNTER, "sliding counter");
+    benchmark(RateLimitMode::SLIDING_LOG, "sliding log");
+
+    return 0;
+}
@@ -0,0 +1,496 @@
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <map>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+/*
+    Why a disk-backed second tier?
+    Anything that is evicted from the Proxy's memory cache, or never
+    fits in it, has to be fetched from RealVideoService again, and a
+    restart starts with an empty cache.
+
+    SegmentCache is a persistent L2 made of append-only segment files:
+    - the active segment is preallocated and memory-mapped, puts are a
+      memcpy into the mapping; reads return a string_view into it
+    - a full segment is sealed with a footer (key, offset, length of
+      every record) and a trailer pointing at that footer
+    - an in-memory index maps key -> (segment, offset, length)
+    - restart reads only the footers to rebuild the index, only the
+      unsealed tail segment is scanned record by record
+    - compaction copies live records out of mostly dead segments
+      into the active one, syncs it, and only then deletes the old files
+
+    Record: [ keyLen u32 | valueLen u32 | checksum u32 | key | value ]
+    valueLen == TOMBSTONE marks a delete. Keys are never empty, so
+    keyLen == 0 (zeroed preallocated space) marks the end of the log.
+*/
+
+class SegmentCache {
+private:
+    static constexpr uint32_t TOMBSTONE = UINT32_MAX;
+    static constexpr uint64_t FOOTER_MAGIC = 0x5345474D454E5431ULL;    // "SEGMENT1"
+
+    struct RecordHeader {
+        uint32_t keyLen;
+        uint32_t valueLen;
+        uint32_t checksum;
+    };
+
+    struct FooterEntry {
+        uint32_t keyLen;
+        uint32_t valueLen;
+        uint64_t recordOffset;
+    };
+
+    struct Trailer {
+        uint64_t footerOffset;
+        uint64_t entryCount;
+        uint64_t magic;
+    };
+
+    struct Segment {
+        uint32_t id;
+        int fd = -1;
+        char* map = nullptr;
+        size_t mappedBytes = 0;
+        size_t dataEnd = 0;         // end of the record area
+        size_t liveBytes = 0;
+        bool sealed = false;
+        vector<pair<string, FooterEntry>> pending;     // footer of the active segment
+        size_t footerBytes = 0;                         // size of that footer once written
+
+        ~Segment() {
+            if (map) munmap(map, mappedBytes);
+            if (fd >= 0) close(fd);
+        }
+    };
+
+    struct Location {
+        uint32_t segment;
+        uint64_t valueOffset;
+        uint32_t valueLen;
+    };
+
+    string dir;
+    size_t segmentBytes;
+    map<uint32_t, unique_ptr<Segment>> segments;
+    unordered_map<string, Location> index;
+    Segment* active = nullptr;
+
+    static uint32_t checksum(string_view key, string_view value) {
+        uint32_t h = 2166136261u;
+        for (char c : key) h = (h ^ (uint8_t)c) * 16777619u;
+        for (char c : value) h = (h ^ (uint8_t)c) * 16777619u;
+        return h;
+    }
+
+    string pathOf(uint32_t id) const {
+        char name[32];
+        snprintf(name, sizeof(name), "/segment-%08u.log", id);
+        return dir + name;
+    }
+
+    static size_t recordSize(const RecordHeader& h) {
+        return sizeof(RecordHeader) + h.keyLen + (h.valueLen == TOMBSTONE ? 0 : h.valueLen);
+    }
+
+    void openActive(uint32_t id) {
+        auto seg = make_unique<Segment>();
+        seg -> id = id;
+        seg -> fd = open(pathOf(id).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (seg -> fd < 0) throw runtime_error("Cannot create segment: " + string(strerror(errno)));
+        if (ftruncate(seg -> fd, segmentBytes) < 0) throw runtime_error("ftruncate failed");
+        void* p = mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, seg -> fd, 0);
+        if (p == MAP_FAILED) throw runtime_error("mmap failed");
+        seg -> map = static_cast<char*>(p);
+        seg -> mappedBytes = segmentBytes;
+        active = seg.get();
+        segments[id] = std::move(seg);
+    }
+
+    // writes the footer after the records, then shrinks the file to fit
+    void seal(Segment& seg) {
+        vector<char> footer;
+        footer.reserve(seg.footerBytes + sizeof(Trailer));
+        for (auto& [key, e] : seg.pending) {
+            footer.insert(footer.end(), (const char*)&e, (const char*)&e + sizeof(e));
+            footer.insert(footer.end(), key.begin(), key.end());
+        }
+        Trailer trailer{seg.dataEnd, seg.pending.size(), FOOTER_MAGIC};
+        footer.insert(footer.end(), (const char*)&trailer, (const char*)&trailer + sizeof(trailer));
+
+        if (pwrite(seg.fd, footer.data(), footer.size(), seg.dataEnd) != (ssize_t)footer.size()) {
+            throw runtime_error("footer write failed");
+        }
+        if (ftruncate(seg.fd, seg.dataEnd + footer.size()) < 0) throw runtime_error("ftruncate failed");
+        fsync(seg.fd);
+
+        // remap read-only at the final size
+        munmap(seg.map, seg.mappedBytes);
+        seg.mappedBytes = seg.dataEnd + footer.size();
+        void* p = mmap(nullptr, seg.mappedBytes, PROT_READ, MAP_SHARED, seg.fd, 0);
+        if (p == MAP_FAILED) throw runtime_error("mmap failed");
+        seg.map = static_cast<char*>(p);
+        seg.pending.clear();
+        seg.pending.shrink_to_fit();
+        seg.sealed = true;
+    }
+
+    void apply(const string& key, uint32_t segment, uint64_t recordOffset, uint32_t keyLen, uint32_t valueLen) {
+        auto old = index.find(key);
+        if (old != index.end()) {
+            segments.at(old -> second.segment) -> liveBytes -= sizeof(RecordHeader) + key.size() + old -> second.valueLen;
+            index.erase(old);
+        }
+        if (valueLen == TOMBSTONE) return;
+        index[key] = Location{segment, recordOffset + sizeof(RecordHeader) + keyLen, valueLen};
+        segments.at(segment) -> liveBytes += sizeof(RecordHeader) + keyLen + valueLen;
+    }
+
+    void append(const string& key, string_view value, uint32_t valueLen) {
+        RecordHeader header{(uint32_t)key.size(), valueLen, checksum(key, value)};
+        size_t need = recordSize(header);
+        if (need + sizeof(Trailer) > segmentBytes) throw invalid_argument("Record larger than a segment: " + key);
+
+        // leave room for the footer of everything in this segment
+        size_t entryBytes = sizeof(FooterEntry) + key.size();
+        if (active -> dataEnd + need + active -> footerBytes + entryBytes + sizeof(Trailer) > segmentBytes) {
+            seal(*active);
+            openActive(segments.rbegin() -> first + 1);
+        }
+
+        char* p = active -> map + active -> dataEnd;
+        memcpy(p, &header, sizeof(header));
+        memcpy(p + sizeof(header), key.data(), key.size());
+        if (valueLen != TOMBSTONE) memcpy(p + sizeof(header) + key.size(), value.data(), value.size());
+
+        uint64_t offset = active -> dataEnd;
+        active -> dataEnd += need;
+        active -> pending.push_back({key, FooterEntry{header.keyLen, valueLen, offset}});
+        active -> footerBytes += entryBytes;
+        apply(key, active -> id, offset, header.keyLen, valueLen);
+    }
+
+    // false unless the trailer and every footer entry stay inside the file
+    bool readFooter(const Segment& s, Trailer& trailer, vector<pair<string, FooterEntry>>& entries) const {
+        if (s.mappedBytes < sizeof(Trailer)) return false;
+        size_t footerEnd = s.mappedBytes - sizeof(Trailer);
+        memcpy(&trailer, s.map + footerEnd, sizeof(Trailer));
+        if (trailer.magic != FOOTER_MAGIC || trailer.footerOffset > footerEnd) return false;
+
+        size_t at = trailer.footerOffset;
+        for (uint64_t i = 0; i < trailer.entryCount; i++) {
+            FooterEntry e;
+            if (footerEnd - at < sizeof(e)) return false;
+            memcpy(&e, s.map + at, sizeof(e));
+            at += sizeof(e);
+            if (e.keyLen == 0 || footerEnd - at < e.keyLen) return false;
+            RecordHeader h{e.keyLen, e.valueLen, 0};
+            if (e.recordOffset > trailer.footerOffset || trailer.footerOffset - e.recordOffset < recordSize(h)) return false;
+            entries.push_back({string(s.map + at, e.keyLen), e});
+            at += e.keyLen;
+        }
+        return at == footerEnd;
+    }
+
+    // sealed segment: footer only; unsealed tail: scan until the first torn record
+    void load(uint32_t id) {
+        auto seg = make_unique<Segment>();
+        seg -> id = id;
+        seg -> fd = open(pathOf(id).c_str(), O_RDWR);
+        if (seg -> fd < 0) throw runtime_error("Cannot open segment " + pathOf(id) + ": " + strerror(errno));
+        struct stat st;
+        if (fstat(seg -> fd, &st) < 0) throw runtime_error("Cannot stat segment " + pathOf(id) + ": " + strerror(errno));
+        seg -> mappedBytes = st.st_size;
+        if (seg -> mappedBytes == 0) return;
+        void* p = mmap(nullptr, seg -> mappedBytes, PROT_READ, MAP_SHARED, seg -> fd, 0);
+        if (p == MAP_FAILED) throw runtime_error("mmap failed");
+        seg -> map = static_cast<char*>(p);
+        Segment* s = seg.get();
+        segments[id] = std::move(seg);
+
+        vector<pair<string, FooterEntry>> entries;
+        Trailer trailer{};
+        if (readFooter(*s, trailer, entries)) {
+            s -> sealed = true;
+            s -> dataEnd = trailer.footerOffset;
+            for (auto& [key, e] : entries) apply(key, id, e.recordOffset, e.keyLen, e.valueLen);
+            return;
+        }
+
+        // crashed while active, or a footer that does not add up: every complete record up to the first bad one counts
+        size_t offset = 0;
+        vector<pair<string, FooterEntry>> recovered;
+        while (offset + sizeof(RecordHeader) <= s -> mappedBytes) {
+            RecordHeader h;
+            memcpy(&h, s -> map + offset, sizeof(h));
+            if (h.keyLen == 0 || offset + recordSize(h) > s -> mappedBytes) break;
+            string_view key(s -> map + offset + sizeof(h), h.keyLen);
+            string_view value(key.data() + h.keyLen, h.valueLen == TOMBSTONE ? 0 : h.valueLen);
+            if (checksum(key, value) != h.checksum) break;
+            recovered.push_back({string(key), FooterEntry{h.keyLen, h.valueLen, offset}});
+            s -> footerBytes += sizeof(FooterEntry) + h.keyLen;
+            offset += recordSize(h);
+        }
+        for (auto& [key, e] : recovered) apply(key, id, e.recordOffset, e.keyLen, e.valueLen);
+        s -> dataEnd = offset;
+        s -> pending = std::move(recovered);
+        seal(*s);
+    }
+
+public:
+    SegmentCache(string dir, size_t segmentBytes = 64 << 20) : dir(std::move(dir)), segmentBytes(segmentBytes) {
+        mkdir(this -> dir.c_str(), 0755);
+        vector<uint32_t> ids;
+        if (DIR* d = opendir(this -> dir.c_str())) {
+            while (dirent* e = readdir(d)) {
+                unsigned id;
+                if (sscanf(e -> d_name, "segment-%08u.log", &id) == 1) ids.push_back(id);
+            }
+            closedir(d);
+        }
+        sort(ids.begin(), ids.end());
+        for (uint32_t id : ids) load(id);       // later segments override earlier ones
+        openActive(ids.empty() ? 1 : ids.back() + 1);
+    }
+
+    ~SegmentCache() {
+        if (!active || active -> sealed) return;
+        if (active -> dataEnd == 0) unlink(pathOf(active -> id).c_str());     // nothing written
+        else seal(*active);
+    }
+
+    void put(const string& key, string_view value) {
+        if (key.empty()) throw invalid_argument("Empty key");     // keyLen == 0 ends the log on recovery
+        if (value.size() >= TOMBSTONE) throw invalid_argument("Value too large: " + key);
+        append(key, value, (uint32_t)value.size());
+    }
+
+    void erase(const string& key) {
+        if (index.count(key)) append(key, {}, TOMBSTONE);
+    }
+
+    // view into the mapped segment, valid until the next put/erase/compact
+    bool get(const string& key, string_view& value) const {
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        const Segment& seg = *segments.at(it -> second.segment);
+        value = string_view(seg.map + it -> second.valueOffset, it -> second.valueLen);
+        return true;
+    }
+
+    // rewrites sealed segments whose live share dropped below minLiveRatio
+    size_t compact(double minLiveRatio = 0.5) {
+        vector<uint32_t> victims;
+        for (auto& [id, seg] : segments) {
+            if (seg -> sealed && seg -> liveBytes < seg -> dataEnd * minLiveRatio) victims.push_back(id);
+        }
+
+        // oldest segment that survives this compaction, victims are in id order
+        uint32_t oldestKept = active -> id;
+        for (auto& [id, seg] : segments) {
+            if (!binary_search(victims.begin(), victims.end(), id)) { oldestKept = id; break; }
+        }
+
+        for (uint32_t id : victims) {
+            Segment& seg = *segments.at(id);
+            bool olderExists = oldestKept < id;
+            for (size_t offset = 0; offset < seg.dataEnd; ) {
+                RecordHeader h;
+                memcpy(&h, seg.map + offset, sizeof(h));
+                string key(seg.map + offset + sizeof(h), h.keyLen);
+                auto it = index.find(key);
+                if (h.valueLen == TOMBSTONE) {
+                    // still needed to mask the key in older segments
+                    if (olderExists && it == index.end()) append(key, {}, TOMBSTONE);
+                }
+                else if (it != index.end() && it -> second.segment == id &&
+                         it -> second.valueOffset == offset + sizeof(h) + h.keyLen) {
+                    string value(seg.map + it -> second.valueOffset, h.valueLen);    // copy: the mapping goes away
+                    append(key, value, h.valueLen);
+                }
+                offset += recordSize(h);
+            }
+        }
+        if (victims.empty()) return 0;
+
+        // the copies must be on disk before the originals go; sealed segments were fsynced by seal
+        if (msync(active -> map, active -> dataEnd, MS_SYNC) < 0) {
+            throw runtime_error("Cannot sync segment " + pathOf(active -> id) + ": " + strerror(errno));
+        }
+        size_t reclaimed = 0;
+        for (uint32_t id : victims) {
+            reclaimed += segments.at(id) -> mappedBytes;
+            segments.erase(id);
+            unlink(pathOf(id).c_str());
+        }
+        return reclaimed;
+    }
+
+    size_t size() const { return index.size(); }
+    size_t segmentCount() const { return segments.size(); }
+};
+
+// --------- Proxy with a memory L1 and the disk L2 ---------
+bool beginWith(const string& a, const string& b) {
+    return a.compare(0, b.size(), b) == 0;
+}
+
+class VideoService {
+public:
+    virtual void playVideo(string userType, string videoName) = 0;
+    virtual ~VideoService() {}
+};
+
+class RealVideoService : public VideoService {
+public:
+    long fetches = 0;
+
+    void playVideo(string, string videoName) override {
+        cout << "Streaming Video: " + videoName << endl;
+    }
+
+    string loadVideo(const string& videoName) {
+        fetches++;
+        return string(4096, (char)videoName.size()) + videoName;
+    }
+};
+
+class ProxyVideoService : public VideoService {
+private:
+    unique_ptr<RealVideoService> realVideoService;
+    size_t memoryEntries;
+    list<pair<string, string>> lru;     // front = most recent
+    unordered_map<string, list<pair<string, string>>::iterator> cachedVideos;
+    SegmentCache& diskCache;
+
+    void remember(const string& videoName, string video) {
+        lru.emplace_front(videoName, std::move(video));
+        cachedVideos[videoName] = lru.begin();
+        if (lru.size() > memoryEntries) {
+            cachedVideos.erase(lru.back().first);   // still on disk
+            lru.pop_back();
+        }
+    }
+public:
+    ProxyVideoService(unique_ptr<RealVideoService> rvs, SegmentCache& diskCache, size_t memoryEntries)
+        : realVideoService(std::move(rvs)), memoryEntries(memoryEntries), diskCache(diskCache) {}
+
+    void playVideo(string userType, string videoName) override {
+        // user content rights validation
+        if (userType != "Premium" && beginWith(videoName, "Premium")) {
+            cout << "Access Denied: Subscribe to access premium content." << endl;
+            return;
+        }
+
+        auto it = cachedVideos.find(videoName);
+        string_view onDisk;
+        if (it != cachedVideos.end()) {
+            lru.splice(lru.begin(), lru, it -> second);
+            cout << "Streaming Cached Video: " + videoName << endl;
+        }
+        else if (diskCache.get(videoName, onDisk)) {
+            remember(videoName, string(onDisk));
+            cout << "Streaming Disk Cached Video: " + videoName << endl;
+        }
+        else {
+            realVideoService -> playVideo(userType, videoName);
+            string video = realVideoService -> loadVideo(videoName);
+            diskCache.put(videoName, video);
+            remember(videoName, std::move(video));
+        }
+    }
+};
+
+// --------- Warm restart benchmark ---------
+double millisSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+void restartBenchmark(const string& dir) {
+    const int videos = 50000;
+    string payload(2048, 'v');
+    {
+        SegmentCache cache(dir, 16 << 20);
+        auto t0 = chrono::steady_clock::now();
+        for (int i = 0; i < videos; i++) cache.put("Video " + to_string(i), payload);
+        for (int i = 0; i < videos; i += 2) cache.put("Video " + to_string(i), payload);     // overwrite half
+        cout << "write " << 1.5 * videos << " records: " << (long)millisSince(t0) << " ms, "
+             << cache.segmentCount() << " segments" << endl;
+
+        t0 = chrono::steady_clock::now();
+        size_t reclaimed = cache.compact(0.6);
+        cout << "compaction: reclaimed " << (reclaimed >> 20) << " MB in " << (long)millisSince(t0) << " ms, "
+             << cache.segmentCount() << " segments left" << endl;
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    SegmentCache reopened(dir, 16 << 20);
+    double ms = millisSince(t0);
+
+    string_view v;
+    bool ok = reopened.get("Video 12345", v) && v == payload && reopened.size() == (size_t)videos;
+    cout << "warm restart: " << reopened.size() << " entries indexed in " << ms << " ms, verified: " << ok << endl;
+}
+
+void removeDir(const string& dir) {
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* e = readdir(d)) {
+            if (e -> d_name[0] != '.') unlink((dir + "/" + e -> d_name).c_str());
+        }
+        closedir(d);
+    }
+    rmdir(dir.c_str());
+}
+
+int main() {
+    char tmp[] = "/tmp/segmentcacheXXXXXX";
+    if (!mkdtemp(tmp)) throw runtime_error("mkdtemp failed");
+    string dir = tmp;
+
+    {
+        SegmentCache diskCache(dir + "/l2");
+        ProxyVideoService proxyService(make_unique<RealVideoService>(), diskCache, 1);
+
+        proxyService.playVideo("Free", "Free Video 1");
+        proxyService.playVideo("Free", "Free Video 2");     // pushes Video 1 out of memory
+        proxyService.playVideo("Free", "Free Video 1");     // served from disk
+        proxyService.playVideo("Free", "Premium Video 1");
+    }
+    {
+        // after a restart the disk tier is still warm
+        SegmentCache diskCache(dir + "/l2");
+        ProxyVideoService proxyService(make_unique<RealVideoService>(), diskCache, 1);
+        proxyService.playVideo("Free", "Free Video 2");
+
+        try {
+            diskCache.put("", "untitled");
+        }
+        catch (const invalid_argument& e) {
+            cout << "Rejected: " << e.what() << endl;
+        }
+    }
+
+    cout << "\n--- 50k x 2 KB videos, 16 MB segments ---" << endl;
+    restartBenchmark(dir + "/bench");
+
+    removeDir(dir + "/l2");
+    removeDir(dir + "/bench");
+    rmdir(dir.c_str());
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <functional>
+#include <string>
+using namespace std;
+
+/*
+    Why a sharded Proxy?
+    ProxyVideoService in ProxyDesign.cpp mutates requestCounts and
+    cachedVideos without any synchronization, so it can only be
+    used from one thread.
+
+    ShardedProxyVideoService splits both maps into N shards chosen
+    by key hash. Every shard has its own shared_mutex, so
+    - cache hits only take a shared lock and mark the entry with
+      an atomic CLOCK reference bit, hits on any shard run in parallel
+    - misses take the exclusive lock of one shard only
+    - request counters are atomics keyed by user, so users spread
+      over the shards and an existing user is counted under a
+      shared lock as well
+    Shards are cache line aligned so neighbouring locks do not
+    false share.
+
+    The load generator replays a Zipf distributed video trace for
+    many users from 1 to 64 threads and reports requests/sec, with
+    the rate limiter counting every request.
+*/
+
+enum class PlayResult { ACCESS_DENIED, RATE_LIMITED, CACHE_HIT, STREAMED };
+
+bool beginWith(const string& a, const string& b) {
+    return a.compare(0, b.size(), b) == 0;
+}
+
+class VideoService {
+public:
+    virtual void playVideo(string userType, string videoName) = 0;
+    virtual ~VideoService() {}
+};
+
+class RealVideoService : public VideoService {
+public:
+    atomic<long> fetches{0};
+
+    void playVideo(string, string videoName) override {
+        cout << "Streaming Video: " + videoName << endl;
+    }
+
+    // the data path without the console, safe from any thread
+    void fetchVideo(const string&) {
+        fetches.fetch_add(1, memory_order_relaxed);
+    }
+};
+
+class ShardedProxyVideoService : public VideoService {
+private:
+    struct CacheEntry {
+        string video;
+        atomic<bool> referenced{false};
+        CacheEntry(string video) : video(std::move(video)) {}
+    };
+
+    struct alignas(64) Shard {
+        shared_mutex lock;
+        unordered_map<string, unique_ptr<CacheEntry>> cachedVideos;
+        vector<string> clockRing;   // eviction order, guarded by the exclusive lock
+        size_t hand = 0;
+        unordered_map<string, unique_ptr<atomic<long>>> requestCounts;
+    };
+
+    unique_ptr<RealVideoService> realVideoService;
+    vector<Shard> shards;
+    size_t entriesPerShard;
+    long requestLimit;
+
+    Shard& shardFor(const string& key) {
+        return shards[hash<string>{}(key) % shards.size()];
+    }
+
+    long countRequest(const string& userId) {
+        Shard& shard = shardFor(userId);
+        {
+            shared_lock<shared_mutex> read(shard.lock);
+            auto it = shard.requestCounts.find(userId);
+            if (it != shard.requestCounts.end()) return it -> second -> fetch_add(1) + 1;
+        }
+        unique_lock<shared_mutex> write(shard.lock);
+        auto& counter = shard.requestCounts[userId];
+        if (!counter) counter = make_unique<atomic<long>>(0);
+        return counter -> fetch_add(1) + 1;
+    }
+
+    bool lookup(const string& videoName) {
+        Shard& shard = shardFor(videoName);
+        shared_lock<shared_mutex> read(shard.lock);
+        auto it = shard.cachedVideos.find(videoName);
+        if (it == shard.cachedVideos.end()) return false;
+        // only store when needed, keeps the line shared between readers
+        if (!it -> second -> referenced.load(memory_order_relaxed)) {
+            it -> second -> referenced.store(true, memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void insert(const string& videoName) {
+        Shard& shard = shardFor(videoName);
+        unique_lock<shared_mutex> write(shard.lock);
+        if (shard.cachedVideos.count(videoName)) return;   // another thread won the race
+
+        if (shard.cachedVideos.size() >= entriesPerShard) {
+            // CLOCK: skip recently referenced entries once
+            while (true) {
+                string& key = shard.clockRing[shard.hand];
+                auto& entry = shard.cachedVideos.at(key);
+                if (entry -> referenced.exchange(false, memory_order_relaxed)) {
+                    shard.hand = (shard.hand + 1) % shard.clockRing.size();
+                    continue;
+                }
+                shard.cachedVideos.erase(key);
+                key = videoName;    // reuse the ring slot
+                break;
+            }
+            shard.hand = (shard.hand + 1) % shard.clockRing.size();
+        }
+        else {
+            shard.clockRing.push_back(videoName);
+        }
+        shard.cachedVideos.emplace(videoName, make_unique<CacheEntry>(videoName));
+    }
+
+public:
+    ShardedProxyVideoService(unique_ptr<RealVideoService> rvs, size_t shardCount = 64,
+                             size_t cacheEntries = 1 << 16, long requestLimit = 5)
+        : realVideoService(std::move(rvs)), shards(shardCount),
+          entriesPerShard(max<size_t>(1, cacheEntries / shardCount)), requestLimit(requestLimit) {}
+
+    // thread-safe request path, no console output
+    PlayResult serve(const string& userId, const string& userType, const string& videoName) {
+        // user content rights validation
+        if (userType != "Premium" && beginWith(videoName, "Premium")) return PlayResult::ACCESS_DENIED;
+
+        // rate limitter, per user
+        if (requestLimit > 0 && countRequest(userId) > requestLimit) return PlayResult::RATE_LIMITED;
+
+        // check video in cache
+        if (lookup(videoName)) return PlayResult::CACHE_HIT;
+
+        realVideoService -> fetchVideo(videoName);
+        insert(videoName);
+        return PlayResult::STREAMED;
+    }
+
+    // the VideoService interface has no user id, so the user type stands in for one
+    void playVideo(string userType, string videoName) override {
+        switch (serve(userType, userType, videoName)) {
+            case PlayResult::ACCESS_DENIED:
+                cout << "Access Denied: Subscribe to access premium content." << endl;
+                break;
+            case PlayResult::RATE_LIMITED:
+                cout << "Access Denied: Too many requests." << endl;
+                break;
+            case PlayResult::CACHE_HIT:
+                cout << "Streaming Cached Video: " + videoName << endl;
+                break;
+            case PlayResult::STREAMED:
+                cout << "Streaming Video: " + videoName << endl;
+                break;
+        }
+    }
+
+    long backendFetches() const { return realVideoService -> fetches.load(); }
+};
+
+// --------- Load generator ---------
+vector<string> zipfTrace(int catalog, int requests, double skew, unsigned seed) {
+    vector<double> cdf(catalog);
+    double sum = 0;
+    for (int i = 0; i < catalog; i++) cdf[i] = (sum += 1.0 / pow(i + 1, skew));
+
+    mt19937 g(seed);
+    uniform_real_distribution<double> u(0, sum);
+    vector<string> trace(requests);
+    for (auto& key : trace) key = "Video " + to_string(lower_bound(cdf.begin(), cdf.end(), u(g)) - cdf.begin());
+    return trace;
+}
+
+void runLoad(const vector<string>& trace, const vector<string>& users, int threads) {
+    // high enough that every request is served, but every request is still counted
+    const long limit = 1 << 20;
+    ShardedProxyVideoService proxy(make_unique<RealVideoService>(), 64, 20000, limit);
+    atomic<long> hits{0}, limited{0};
+    for (size_t i = 0; i < trace.size(); i++) proxy.serve(users[i % users.size()], "Premium", trace[i]);   // warm up so every run starts hot
+
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            long localHits = 0, localLimited = 0;
+            // every thread replays the whole trace from its own offset
+            size_t n = trace.size(), start = n / threads * t;
+            for (size_t i = 0; i < n; i++) {
+                size_t r = (start + i) % n;
+                PlayResult result = proxy.serve(users[r % users.size()], "Premium", trace[r]);
+                localHits += result == PlayResult::CACHE_HIT;
+                localLimited += result == PlayResult::RATE_LIMITED;
+            }
+            hits += localHits;
+            limited += localLimited;
+        });
+    }
+    for (auto& w : workers) w.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    long total = (long)trace.size() * threads;
+    cout << threads << " threads: " << (long)(total / secs) << " requests/sec, hit ratio "
+         << (100 * hits.load() / total) << "%, " << limited.load() << " rate limited" << endl;
+}
+
+int main() {
+    ShardedProxyVideoService proxyService(make_unique<RealVideoService>());
+
+    proxyService.playVideo("Free", "Free Video 1");
+    proxyService.playVideo("Premium", "Premium Video 1");
+
+    proxyService.playVideo("Free", "Premium Video 1");
+
+    for (int i = 0; i < 6; i++) {
+        proxyService.playVideo("Free", "Free Video 1");
+    }
+
+    cout << "\n--- Zipf(0.99) trace, 100k videos, cache 20k entries, 10k users ---" << endl;
+    auto trace = zipfTrace(100000, 200000, 0.99, 3);
+    vector<string> users;
+    for (int u = 0; u < 10000; u++) users.push_back("User " + to_string(u));
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        runLoad(trace, users, threads);
+    }
+
+    return 0;
+}
@@ -0,0 +1,321 @@
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+using namespace std;
+
+/*
+    Why Single-Flight?
+    In ProxyDesign.cpp a cache miss calls realVideoService -> playVideo
+    before cachedVideos[videoName] is set. When many clients ask for
+    the same uncached video at once every one of them misses and
+    every one of them goes to the backend (thundering herd).
+
+    SingleFlightCache makes the first miss the only fetch:
+    - concurrent misses for the same key wait on its shared_future
+    - failures are cached for a short negative TTL, so a broken
+      video is not retried by every client
+    - stale-while-revalidate: after the fresh TTL an entry is still
+      served while one background refresh replaces it; refreshes run
+      on a single worker, and a failed refresh is retried only after
+      a backoff that doubles with every failure
+    The proxy keeps the content-rights check and the per-user-type
+    request limit of ProxyDesign.cpp in front of the cache.
+*/
+
+using Clock = chrono::steady_clock;
+
+struct SingleFlightConfig {
+    chrono::milliseconds freshFor{60000};
+    chrono::milliseconds negativeFor{1000};
+    bool staleWhileRevalidate = false;
+};
+
+class SingleFlightCache {
+private:
+    struct Entry {
+        shared_future<string> value;        // ready, failed or still in flight
+        Clock::time_point loadedAt;
+        bool failed = false;
+        bool refreshing = false;
+        int refreshFailures = 0;
+        Clock::time_point retryRefreshAt;   // backoff after failed refreshes
+    };
+
+    using Loader = function<string(const string&)>;
+
+    mutex lock;
+    unordered_map<string, Entry> entries;
+    SingleFlightConfig config;
+    atomic<long> coalesced{0};
+
+    // one background worker for every refresh
+    deque<pair<string, Loader>> refreshQueue;
+    condition_variable refreshReady;
+    bool stopping = false;
+    thread refresher;
+
+    static bool isReady(const shared_future<string>& f) {
+        return f.wait_for(chrono::seconds(0)) == future_status::ready;
+    }
+
+    // runs the loader, records when it landed, then wakes the waiters
+    void load(const string& key, const Loader& loader, promise<string>& result) {
+        string value;
+        exception_ptr error;
+        try {
+            value = loader(key);
+        }
+        catch (...) {
+            error = current_exception();
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            Entry& entry = entries[key];
+            entry.loadedAt = Clock::now();
+            entry.failed = error != nullptr;
+            entry.refreshing = false;
+        }
+        if (error) result.set_exception(error);
+        else result.set_value(std::move(value));
+    }
+
+    void refreshLoop() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            refreshReady.wait(guard, [this] { return stopping || !refreshQueue.empty(); });
+            if (stopping) return;
+            auto [key, loader] = std::move(refreshQueue.front());
+            refreshQueue.pop_front();
+            guard.unlock();
+
+            promise<string> fresh;
+            shared_future<string> future = fresh.get_future().share();
+            bool ok = true;
+            try {
+                fresh.set_value(loader(key));
+            }
+            catch (...) {
+                ok = false;     // keep serving the stale copy
+            }
+
+            guard.lock();
+            Entry& entry = entries[key];
+            if (ok) {
+                entry.value = future;
+                entry.loadedAt = Clock::now();
+                entry.refreshFailures = 0;
+            }
+            else {
+                entry.refreshFailures = min(entry.refreshFailures + 1, 10);
+                entry.retryRefreshAt = Clock::now() + config.negativeFor * (1 << (entry.refreshFailures - 1));
+            }
+            entry.refreshing = false;
+        }
+    }
+
+public:
+    SingleFlightCache(SingleFlightConfig config) : config(config), refresher([this] { refreshLoop(); }) {}
+
+    ~SingleFlightCache() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        refreshReady.notify_one();
+        refresher.join();
+    }
+
+    // throws whatever the loader threw, for the caller and every waiter
+    string get(const string& key, const Loader& loader) {
+        unique_lock<mutex> guard(lock);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            Entry& entry = it -> second;
+            if (!isReady(entry.value)) {
+                coalesced++;
+                shared_future<string> inFlight = entry.value;
+                guard.unlock();
+                return inFlight.get();
+            }
+
+            auto age = Clock::now() - entry.loadedAt;
+            auto ttl = entry.failed ? config.negativeFor : config.freshFor;
+            if (age < ttl) {
+                shared_future<string> ready = entry.value;
+                guard.unlock();
+                return ready.get();
+            }
+
+            if (!entry.failed && config.staleWhileRevalidate) {
+                if (!entry.refreshing && Clock::now() >= entry.retryRefreshAt) {
+                    entry.refreshing = true;
+                    refreshQueue.emplace_back(key, loader);
+                    refreshReady.notify_one();
+                }
+                return entry.value.get();
+            }
+        }
+
+        // first miss: publish the future before fetching so others can wait on it
+        promise<string> result;
+        Entry& entry = entries[key];
+        entry.value = result.get_future().share();
+        entry.failed = false;
+        shared_future<string> mine = entry.value;
+        guard.unlock();
+
+        load(key, loader, result);
+        return mine.get();
+    }
+
+    long coalescedRequests() const { return coalesced.load(); }
+};
+
+// --------- Proxy ---------
+class VideoService {
+public:
+    virtual void playVideo(string userType, string videoName) = 0;
+    virtual ~VideoService() {}
+};
+
+class RealVideoService : public VideoService {
+private:
+    chrono::milliseconds latency;
+public:
+    atomic<long> backendCalls{0};
+
+    RealVideoService(chrono::milliseconds latency = chrono::milliseconds(50)) : latency(latency) {}
+
+    void playVideo(string, string videoName) override {
+        cout << "Streaming Video: " + fetchVideo(videoName) << endl;
+    }
+
+    // simulated origin fetch, videos starting with "Missing" fail
+    string fetchVideo(const string& videoName) {
+        backendCalls++;
+        this_thread::sleep_for(latency);
+        if (videoName.rfind("Missing", 0) == 0) throw runtime_error("404 " + videoName);
+        return videoName;
+    }
+};
+
+bool beginWith(const string& a, const string& b) {
+    return a.compare(0, b.size(), b) == 0;
+}
+
+class ProxyVideoService : public VideoService {
+private:
+    unique_ptr<RealVideoService> realVideoService;
+    mutex countsLock;
+    unordered_map<string, int> requestCounts;
+    int requestLimit;
+    SingleFlightCache cachedVideos;
+
+    // content rights and rate limit, nullptr if the request may go on
+    const char* denyReason(const string& userType, const string& videoName) {
+        // user content rights validation
+        if (userType != "Premium" && beginWith(videoName, "Premium")) {
+            return "Access Denied: Subscribe to access premium content.";
+        }
+
+        // rate limitter
+        lock_guard<mutex> guard(countsLock);
+        if (++requestCounts[userType] > requestLimit) {
+            return "Access Denied: Too many requests.";
+        }
+        return nullptr;
+    }
+public:
+    ProxyVideoService(unique_ptr<RealVideoService> rvs, SingleFlightConfig config, int requestLimit = 5)
+        : realVideoService(std::move(rvs)), requestLimit(requestLimit), cachedVideos(config) {}
+
+    void playVideo(string userType, string videoName) override {
+        if (const char* reason = denyReason(userType, videoName)) {
+            cout << reason << endl;
+            return;
+        }
+        try {
+            string video = cachedVideos.get(videoName, [this](const string& name) {
+                return realVideoService -> fetchVideo(name);
+            });
+            cout << "Streaming Video: " + video << endl;
+        }
+        catch (const exception& e) {
+            cout << "Video unavailable: " << e.what() << endl;
+        }
+    }
+
+    // quiet request path for the benchmark
+    bool fetch(const string& userType, const string& videoName) {
+        if (denyReason(userType, videoName)) return false;
+        try {
+            cachedVideos.get(videoName, [this](const string& name) { return realVideoService -> fetchVideo(name); });
+            return true;
+        }
+        catch (const exception&) {
+            return false;
+        }
+    }
+
+    long backendCalls() const { return realVideoService -> backendCalls.load(); }
+};
+
+// --------- Benchmark ---------
+void thunderingHerd(bool coalesce, int clients, int keys) {
+    auto backend = make_unique<RealVideoService>(chrono::milliseconds(20));
+    RealVideoService* raw = backend.get();
+    ProxyVideoService proxy(std::move(backend), SingleFlightConfig{}, clients);
+
+    auto t0 = Clock::now();
+    vector<thread> threads;
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&, c] {
+            string video = "Video " + to_string(c % keys);
+            if (coalesce) proxy.fetch("Premium", video);
+            else raw -> fetchVideo(video);          // what every client did before
+        });
+    }
+    for (auto& t : threads) t.join();
+    double ms = chrono::duration<double, milli>(Clock::now() - t0).count();
+
+    cout << (coalesce ? "single-flight: " : "no coalescing: ") << raw -> backendCalls.load()
+         << " backend calls for " << clients << " clients / " << keys << " keys, " << (long)ms << " ms" << endl;
+}
+
+int main() {
+    SingleFlightConfig config;
+    config.freshFor = chrono::milliseconds(100);
+    config.negativeFor = chrono::milliseconds(100);
+    config.staleWhileRevalidate = true;
+
+    auto realService = make_unique<RealVideoService>(chrono::milliseconds(20));
+    auto proxyService = make_unique<ProxyVideoService>(std::move(realService), config);
+
+    proxyService -> playVideo("Free", "Free Video 1");
+    proxyService -> playVideo("Free", "Premium Video 1");       // no rights, never reaches the cache
+    proxyService -> playVideo("Free", "Free Video 1");          // fresh hit
+    proxyService -> playVideo("Free", "Missing Video");
+    proxyService -> playVideo("Free", "Missing Video");         // negative cache hit
+
+    this_thread::sleep_for(chrono::milliseconds(150));
+    proxyService -> playVideo("Free", "Free Video 1");          // stale, refreshed in background
+    proxyService -> playVideo("Free", "Free Video 1");          // over the Free limit of 5
+    cout << "backend calls: " << proxyService -> backendCalls() << endl;
+
+    cout << "\n--- 256 concurrent clients, 8 cold keys, 20 ms backend ---" << endl;
+    thunderingHerd(false, 256, 8);
+    thunderingHerd(true, 256, 8);
+
+    return 0;
+}
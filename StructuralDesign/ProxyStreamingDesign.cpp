@@ -0,0 +1,344 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+using namespace std;
+
+/*
+    Why a streaming backend behind the Proxy?
+    RealVideoService::playVideo in ProxyDesign.cpp only prints a line,
+    there is no data path. StreamingVideoService serves the bytes of
+    local video files to a socket or pipe in fixed-size chunks.
+
+    Transfer modes, from most to least copying:
+        READ_WRITE   read() into a user buffer, write() it out (baseline)
+        MMAP_WRITE   write() straight out of the mapped file
+        SENDFILE     sendfile(), page cache to socket inside the kernel
+        SPLICE       splice() file -> pipe -> socket, pages are moved
+
+    Requests carry an HTTP-style Range ("bytes=0-499", "bytes=500-",
+    "bytes=-500"). Mapped files are advised MADV_SEQUENTIAL, and the
+    next chunks are hinted with MADV_WILLNEED as the stream advances.
+
+    The benchmark streams a temporary file over a Unix socketpair
+    and reports GB/s for every mode.
+*/
+
+enum class TransferMode { READ_WRITE, MMAP_WRITE, SENDFILE, SPLICE };
+
+struct ByteRange {
+    size_t offset;
+    size_t length;
+};
+
+// parses "bytes=a-b", "bytes=a-" and "bytes=-n"; empty means the whole file
+ByteRange parseRange(const string& header, size_t fileSize) {
+    if (header.empty()) return {0, fileSize};
+    if (header.rfind("bytes=", 0) != 0) throw invalid_argument("Unsupported range unit: " + header);
+
+    string spec = header.substr(6);
+    size_t dash = spec.find('-');
+    if (dash == string::npos || spec.find(',') != string::npos) throw invalid_argument("Bad range: " + header);
+
+    string first = spec.substr(0, dash), last = spec.substr(dash + 1);
+    size_t start, end;
+    if (first.empty()) {            // suffix: the last n bytes
+        size_t n = min<size_t>(stoull(last), fileSize);
+        start = fileSize - n;
+        end = fileSize;
+    }
+    else {
+        start = stoull(first);
+        end = last.empty() ? fileSize : min<size_t>(stoull(last) + 1, fileSize);
+    }
+    if (start >= fileSize || start >= end) throw out_of_range("Range not satisfiable: " + header);
+    return {start, end - start};
+}
+
+class VideoFile {
+private:
+    int fd = -1;
+    size_t size = 0;
+    char* mapped = nullptr;
+public:
+    VideoFile(const string& path) {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("Cannot open " + path + ": " + strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            string reason = strerror(errno);
+            close(fd);
+            throw runtime_error("Cannot stat " + path + ": " + reason);
+        }
+        if (!S_ISREG(st.st_mode)) {
+            close(fd);
+            throw runtime_error("Not a video file: " + path);
+        }
+        size = st.st_size;
+        if (size > 0) {
+            void* p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                string reason = strerror(errno);
+                close(fd);
+                throw runtime_error("mmap failed: " + reason);
+            }
+            mapped = static_cast<char*>(p);
+            madvise(mapped, size, MADV_SEQUENTIAL);
+        }
+    }
+
+    ~VideoFile() {
+        if (mapped) munmap(mapped, size);
+        if (fd >= 0) close(fd);
+    }
+
+    VideoFile(const VideoFile&) = delete;
+    VideoFile& operator=(const VideoFile&) = delete;
+
+    int descriptor() const { return fd; }
+    size_t length() const { return size; }
+    const char* data() const { return mapped; }
+
+    // read-ahead hint for the next window, page aligned as madvise requires
+    void willNeed(size_t offset, size_t length) const {
+        if (!mapped || offset >= size) return;
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t begin = offset & ~(page - 1);
+        length = min(length + (offset - begin), size - begin);
+        madvise(mapped + begin, length, MADV_WILLNEED);
+    }
+};
+
+class VideoService {
+public:
+    virtual void playVideo(string userType, string videoName) = 0;
+    virtual ~VideoService() {}
+};
+
+class StreamingVideoService : public VideoService {
+private:
+    string libraryDir;
+    size_t chunkSize;
+    size_t readAheadChunks;
+
+    static void writeAll(int out, const char* p, size_t n) {
+        while (n > 0) {
+            ssize_t w = write(out, p, n);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                throw runtime_error("write failed: " + string(strerror(errno)));
+            }
+            p += w;
+            n -= w;
+        }
+    }
+
+    void readWrite(const VideoFile& file, ByteRange range, int out) {
+        vector<char> buffer(chunkSize);
+        size_t done = 0;
+        while (done < range.length) {
+            ssize_t r = pread(file.descriptor(), buffer.data(), min(chunkSize, range.length - done), range.offset + done);
+            if (r <= 0) throw runtime_error("read failed");
+            writeAll(out, buffer.data(), r);
+            done += r;
+        }
+    }
+
+    void mmapWrite(const VideoFile& file, ByteRange range, int out) {
+        for (size_t done = 0; done < range.length; done += chunkSize) {
+            size_t n = min(chunkSize, range.length - done);
+            file.willNeed(range.offset + done + n, chunkSize * readAheadChunks);
+            writeAll(out, file.data() + range.offset + done, n);
+        }
+    }
+
+    void sendFile(const VideoFile& file, ByteRange range, int out) {
+        off_t offset = range.offset;
+        size_t left = range.length;
+        while (left > 0) {
+            file.willNeed(offset + chunkSize, chunkSize * readAheadChunks);
+            ssize_t sent = sendfile(out, file.descriptor(), &offset, min(chunkSize, left));
+            if (sent <= 0) {
+                if (sent < 0 && errno == EINTR) continue;
+                throw runtime_error("sendfile failed: " + string(strerror(errno)));
+            }
+            left -= sent;
+        }
+    }
+
+    void spliceFile(const VideoFile& file, ByteRange range, int out) {
+        int pipeFds[2];
+        if (pipe(pipeFds) < 0) throw runtime_error("pipe failed");
+        fcntl(pipeFds[1], F_SETPIPE_SZ, (int)chunkSize);
+
+        loff_t offset = range.offset;
+        size_t left = range.length;
+        try {
+            while (left > 0) {
+                file.willNeed(offset + chunkSize, chunkSize * readAheadChunks);
+                ssize_t in = splice(file.descriptor(), &offset, pipeFds[1], nullptr, min(chunkSize, left), SPLICE_F_MOVE | SPLICE_F_MORE);
+                if (in <= 0) throw runtime_error("splice from file failed: " + string(strerror(errno)));
+                for (ssize_t drained = 0; drained < in; ) {
+                    ssize_t o = splice(pipeFds[0], nullptr, out, nullptr, in - drained, SPLICE_F_MOVE | SPLICE_F_MORE);
+                    if (o <= 0) throw runtime_error("splice to socket failed: " + string(strerror(errno)));
+                    drained += o;
+                }
+                left -= in;
+            }
+        }
+        catch (...) {
+            close(pipeFds[0]);
+            close(pipeFds[1]);
+            throw;
+        }
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+    }
+
+    // video names are plain file names inside the library, never paths
+    string pathFor(const string& videoName) const {
+        if (videoName.empty() || videoName == "." || videoName.find('/') != string::npos
+            || videoName.find("..") != string::npos || videoName.find('\0') != string::npos) {
+            throw invalid_argument("Invalid video name: " + videoName);
+        }
+        return libraryDir + "/" + videoName;
+    }
+
+public:
+    StreamingVideoService(string libraryDir, size_t chunkSize = 1 << 20, size_t readAheadChunks = 4)
+        : libraryDir(std::move(libraryDir)), chunkSize(chunkSize), readAheadChunks(readAheadChunks) {}
+
+    void playVideo(string, string videoName) override {
+        VideoFile file(pathFor(videoName));
+        cout << "Streaming Video: " + videoName << " (" << file.length() << " bytes)" << endl;
+    }
+
+    // returns the number of bytes written to `out`
+    size_t stream(const string& videoName, const string& rangeHeader, int out, TransferMode mode) {
+        VideoFile file(pathFor(videoName));
+        ByteRange range = parseRange(rangeHeader, file.length());
+        switch (mode) {
+            case TransferMode::READ_WRITE: readWrite(file, range, out); break;
+            case TransferMode::MMAP_WRITE: mmapWrite(file, range, out); break;
+            case TransferMode::SENDFILE: sendFile(file, range, out); break;
+            case TransferMode::SPLICE: spliceFile(file, range, out); break;
+        }
+        return range.length;
+    }
+};
+
+bool beginWith(const string& a, const string& b) {
+    return a.compare(0, b.size(), b) == 0;
+}
+
+class ProxyVideoService : public VideoService {
+private:
+    unique_ptr<StreamingVideoService> realVideoService;
+public:
+    ProxyVideoService(unique_ptr<StreamingVideoService> svs) : realVideoService(std::move(svs)) {}
+
+    void playVideo(string userType, string videoName) override {
+        if (userType != "Premium" && beginWith(videoName, "Premium")) {
+            cout << "Access Denied: Subscribe to access premium content." << endl;
+            return;
+        }
+        realVideoService -> playVideo(userType, videoName);
+    }
+
+    size_t streamVideo(const string& userType, const string& videoName, const string& range, int out) {
+        if (userType != "Premium" && beginWith(videoName, "Premium")) {
+            throw runtime_error("Access Denied: Subscribe to access premium content.");
+        }
+        return realVideoService -> stream(videoName, range, out, TransferMode::SPLICE);
+    }
+};
+
+// --------- Benchmark ---------
+// drains the socket like a client would, returns bytes received
+size_t drain(int fd) {
+    vector<char> buffer(1 << 20);
+    size_t total = 0;
+    ssize_t r;
+    while ((r = read(fd, buffer.data(), buffer.size())) > 0) total += r;
+    return total;
+}
+
+void benchmark(StreamingVideoService& service, const string& videoName, TransferMode mode, const string& label, int rounds) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) throw runtime_error("socketpair failed");
+
+    size_t received = 0;
+    thread client([&] { received = drain(sv[1]); });
+
+    auto t0 = chrono::steady_clock::now();
+    size_t sent = 0;
+    for (int i = 0; i < rounds; i++) sent += service.stream(videoName, "", sv[0], mode);
+    shutdown(sv[0], SHUT_WR);
+    client.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    close(sv[0]);
+    close(sv[1]);
+    cout << label << ": " << (sent / secs / 1e9) << " GB/s" << (received == sent ? "" : "  SHORT READ") << endl;
+}
+
+int main() {
+    char dir[] = "/tmp/videosXXXXXX";
+    if (!mkdtemp(dir)) throw runtime_error("mkdtemp failed");
+    string library = dir;
+
+    // 64 MB test video
+    const size_t videoBytes = 64 << 20;
+    {
+        int fd = open((library + "/Free Video 1").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        vector<char> block(1 << 20);
+        for (size_t i = 0; i < block.size(); i++) block[i] = (char)(i * 131);
+        for (size_t done = 0; done < videoBytes; done += block.size()) {
+            if (write(fd, block.data(), block.size()) != (ssize_t)block.size()) throw runtime_error("write failed");
+        }
+        close(fd);
+    }
+
+    auto streaming = make_unique<StreamingVideoService>(library);
+    StreamingVideoService* service = streaming.get();
+    ProxyVideoService proxyService(std::move(streaming));
+
+    proxyService.playVideo("Free", "Free Video 1");
+    proxyService.playVideo("Free", "Premium Video 1");
+    try {
+        proxyService.playVideo("Free", "../../etc/passwd");
+    }
+    catch (const invalid_argument& e) {
+        cout << e.what() << endl;
+    }
+
+    // a byte range through the proxy, into a pipe
+    int pipeFds[2];
+    if (pipe(pipeFds) < 0) throw runtime_error("pipe failed");
+    size_t n = proxyService.streamVideo("Free", "Free Video 1", "bytes=1000-1999", pipeFds[1]);
+    char check[1000];
+    ssize_t got = read(pipeFds[0], check, sizeof(check));
+    cout << "Range bytes=1000-1999: " << n << " bytes, first byte ok: " << (got > 0 && check[0] == (char)(1000 * 131)) << endl;
+    close(pipeFds[0]);
+    close(pipeFds[1]);
+
+    cout << "\n--- 64 MB video x 8 over a Unix socket ---" << endl;
+    benchmark(*service, "Free Video 1", TransferMode::READ_WRITE, "read + write", 8);
+    benchmark(*service, "Free Video 1", TransferMode::MMAP_WRITE, "mmap + write", 8);
+    benchmark(*service, "Free Video 1", TransferMode::SENDFILE, "sendfile    ", 8);
+    benchmark(*service, "Free Video 1", TransferMode::SPLICE, "splice      ", 8);
+
+    unlink((library + "/Free Video 1").c_str());
+    rmdir(dir);
+    return 0;
+}
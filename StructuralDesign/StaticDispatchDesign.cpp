@@ -0,0 +1,516 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <variant>
+#include <concepts>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+using namespace std;
+
+/*
+    Why Static Dispatch?
+    SmartDevice, Coffee, Vehicle, PaymentStrategy and PlayerStrategy
+    are all virtual interfaces held in unique_ptr. Every call is an
+    indirect jump through a vtable the compiler can not see through,
+    so nothing in a hot loop gets inlined.
+
+    When the set of types is known at compile time the same patterns
+    can be written without virtual calls:
+    - CRTP            SmartDevice adapters
+    - templates       Coffee decorators   (Sugar<Milk<Espresso>>)
+    - std::variant    Vehicle / PaymentStrategy, dispatched by std::visit
+    - concepts        PlayerStrategy as a constrained template parameter
+
+    The benchmark runs each pattern both ways over the same workload
+    and reports calls/sec, bytes per object and cache misses (through
+    perf_event_open, "n/a" where the kernel does not allow it).
+    For code size compare the hot loop of each form, one noinline
+    function per pattern and dispatch (benchCoffeeVirtual vs
+    benchCoffeeStatic, ...):
+        nm -C --size-sort ./a.out | grep -E 'bench\w+(Virtual|Static)'
+*/
+
+// sink so the optimizer can not drop the work
+static volatile long blackhole;
+
+// --------- SmartDevice: virtual vs CRTP ---------
+namespace dynamic_device {
+    class SmartDevice {
+    public:
+        virtual void turnOn() = 0;
+        virtual void turnOff() = 0;
+        virtual ~SmartDevice() {}
+    };
+
+    class SmartLightAdapter : public SmartDevice {
+    public:
+        long switches = 0;
+        void turnOn() override { switches++; }
+        void turnOff() override { switches += 2; }
+    };
+
+    class AirConditionerAdapter : public SmartDevice {
+    public:
+        long cycles = 0;
+        void turnOn() override { cycles += 3; }
+        void turnOff() override { cycles += 5; }
+    };
+}
+
+namespace static_device {
+    template <typename Derived>
+    class SmartDevice {
+    public:
+        void turnOn() { static_cast<Derived*>(this) -> turnOnImpl(); }
+        void turnOff() { static_cast<Derived*>(this) -> turnOffImpl(); }
+    };
+
+    class SmartLightAdapter : public SmartDevice<SmartLightAdapter> {
+    public:
+        long switches = 0;
+        void turnOnImpl() { switches++; }
+        void turnOffImpl() { switches += 2; }
+    };
+
+    class AirConditionerAdapter : public SmartDevice<AirConditionerAdapter> {
+    public:
+        long cycles = 0;
+        void turnOnImpl() { cycles += 3; }
+        void turnOffImpl() { cycles += 5; }
+    };
+}
+
+// --------- Coffee: virtual decorator vs template decorator ---------
+namespace dynamic_coffee {
+    class Coffee {
+    public:
+        virtual double getCost() = 0;
+        virtual ~Coffee() {}
+    };
+
+    class Espresso : public Coffee {
+    public:
+        double getCost() override { return 4.5; }
+    };
+
+    class CoffeeDecorator : public Coffee {
+    protected:
+        unique_ptr<Coffee> coffee;
+    public:
+        CoffeeDecorator(unique_ptr<Coffee> coffee) : coffee(std::move(coffee)) {}
+    };
+
+    class MilkDecorator : public CoffeeDecorator {
+    public:
+        using CoffeeDecorator::CoffeeDecorator;
+        double getCost() override { return coffee -> getCost() + 0.5; }
+    };
+
+    class SugarDecorator : public CoffeeDecorator {
+    public:
+        using CoffeeDecorator::CoffeeDecorator;
+        double getCost() override { return coffee -> getCost() + 0.25; }
+    };
+}
+
+namespace static_coffee {
+    template <typename T>
+    concept CoffeeLike = requires(const T& c) {
+        { c.getCost() } -> convertible_to<double>;
+    };
+
+    struct Espresso {
+        double getCost() const { return 4.5; }
+    };
+
+    template <CoffeeLike Inner>
+    struct Milk {
+        Inner coffee;
+        double getCost() const { return coffee.getCost() + 0.5; }
+    };
+
+    template <CoffeeLike Inner>
+    struct Sugar {
+        Inner coffee;
+        double getCost() const { return coffee.getCost() + 0.25; }
+    };
+}
+
+// --------- Vehicle: virtual vs variant ---------
+namespace dynamic_vehicle {
+    class Vehicle {
+    public:
+        virtual void move() = 0;
+        virtual ~Vehicle() {}
+    };
+
+    class Bike : public Vehicle {
+    public:
+        long distance = 0;
+        void move() override { distance += 1; }
+    };
+
+    class Car : public Vehicle {
+    public:
+        long distance = 0;
+        void move() override { distance += 4; }
+    };
+}
+
+namespace static_vehicle {
+    struct Bike {
+        long distance = 0;
+        void move() { distance += 1; }
+    };
+
+    struct Car {
+        long distance = 0;
+        void move() { distance += 4; }
+    };
+
+    using Vehicle = variant<Bike, Car>;
+}
+
+// --------- PaymentStrategy: virtual vs variant ---------
+namespace dynamic_payment {
+    class PaymentStrategy {
+    public:
+        virtual long processPayment(int amt) = 0;
+        virtual ~PaymentStrategy() {}
+    };
+
+    class CreditCard : public PaymentStrategy {
+    public:
+        long processPayment(int amt) override { return amt + amt / 50; }   // 2% fee
+    };
+
+    class DebitCard : public PaymentStrategy {
+    public:
+        long processPayment(int amt) override { return amt + 1; }          // flat fee
+    };
+}
+
+namespace static_payment {
+    struct CreditCard {
+        long processPayment(int amt) const { return amt + amt / 50; }
+    };
+
+    struct DebitCard {
+        long processPayment(int amt) const { return amt + 1; }
+    };
+
+    using PaymentStrategy = variant<CreditCard, DebitCard>;
+}
+
+// --------- PlayerStrategy: virtual vs concept ---------
+struct Position {
+    int row, col;
+};
+
+struct Board {
+    char cells[3][3];
+    bool isValidMove(Position p) const { return cells[p.row][p.col] == ' '; }
+};
+
+namespace dynamic_player {
+    class PlayerStrategy {
+    public:
+        virtual Position makeMove(const Board& board) = 0;
+        virtual ~PlayerStrategy() {}
+    };
+
+    class FirstFreeStrategy : public PlayerStrategy {
+    public:
+        Position makeMove(const Board& board) override {
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++)
+                    if (board.isValidMove({r, c})) return {r, c};
+            return {-1, -1};
+        }
+    };
+}
+
+namespace static_player {
+    template <typename S>
+    concept PlayerStrategy = requires(S s, const Board& b) {
+        { s.makeMove(b) } -> same_as<Position>;
+    };
+
+    struct FirstFreeStrategy {
+        Position makeMove(const Board& board) {
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++)
+                    if (board.isValidMove({r, c})) return {r, c};
+            return {-1, -1};
+        }
+    };
+
+    template <PlayerStrategy S>
+    class Player {
+    private:
+        S strategy;
+    public:
+        Position makeMove(const Board& board) { return strategy.makeMove(board); }
+    };
+}
+
+// --------- Benchmark harness ---------
+class CacheMissCounter {
+private:
+    int fd = -1;
+public:
+    CacheMissCounter() {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~CacheMissCounter() { if (fd >= 0) close(fd); }
+
+    void start() {
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    long stop() {
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+        return (long)count;
+    }
+};
+
+void runBench(const string& label, long calls, size_t bytesPerObject, const function<void()>& body) {
+    CacheMissCounter misses;
+    misses.start();
+    auto t0 = chrono::steady_clock::now();
+    body();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    long missCount = misses.stop();
+
+    cout << "  " << label << ": " << (long)(calls / secs / 1e6) << " M calls/sec, "
+         << bytesPerObject << " B/object, cache misses "
+         << (missCount < 0 ? string("n/a") : to_string(missCount)) << endl;
+}
+
+constexpr int OBJECTS = 4096;
+constexpr int ROUNDS = 2000;
+constexpr long CALLS = (long)OBJECTS * ROUNDS;
+
+// the same pseudo random type mix for every benchmark
+vector<int> typeMix() {
+    mt19937 g(42);
+    vector<int> mix(OBJECTS);
+    for (auto& t : mix) t = g() & 1;
+    return mix;
+}
+
+// average footprint of a mixed container: the element plus, for
+// owning pointers, the heap object of the type chosen by the mix
+template <typename Element, typename A, typename B>
+size_t mixedBytes(const vector<int>& mix) {
+    size_t heap = 0;
+    for (int t : mix) heap += t ? sizeof(A) : sizeof(B);
+    return sizeof(Element) + heap / mix.size();
+}
+
+// each hot loop is its own noinline function so their code sizes
+// can be compared with nm (bench<Pattern><Dispatch>)
+__attribute__((noinline)) void benchSmartDeviceVirtual(vector<unique_ptr<dynamic_device::SmartDevice>>& devices) {
+    for (int r = 0; r < ROUNDS; r++)
+        for (auto& d : devices) (r & 1) ? d -> turnOff() : d -> turnOn();
+}
+
+__attribute__((noinline)) void benchSmartDeviceStatic(vector<static_device::SmartLightAdapter>& lights,
+                                                      vector<static_device::AirConditionerAdapter>& acs) {
+    for (int r = 0; r < ROUNDS; r++) {
+        for (auto& d : lights) (r & 1) ? d.turnOff() : d.turnOn();
+        for (auto& d : acs) (r & 1) ? d.turnOff() : d.turnOn();
+    }
+}
+
+void benchSmartDevice() {
+    cout << "SmartDevice" << endl;
+    auto mix = typeMix();
+
+    vector<unique_ptr<dynamic_device::SmartDevice>> dyn;
+    for (int t : mix) {
+        if (t) dyn.push_back(make_unique<dynamic_device::SmartLightAdapter>());
+        else dyn.push_back(make_unique<dynamic_device::AirConditionerAdapter>());
+    }
+    size_t dynBytes = mixedBytes<unique_ptr<dynamic_device::SmartDevice>, dynamic_device::SmartLightAdapter,
+                                 dynamic_device::AirConditionerAdapter>(mix);
+    runBench("virtual", CALLS, dynBytes, [&] { benchSmartDeviceVirtual(dyn); });
+
+    // CRTP: homogeneous containers per concrete adapter
+    vector<static_device::SmartLightAdapter> lights;
+    vector<static_device::AirConditionerAdapter> acs;
+    for (int t : mix) {
+        if (t) lights.emplace_back();
+        else acs.emplace_back();
+    }
+    size_t staticBytes = (lights.size() * sizeof(static_device::SmartLightAdapter)
+                          + acs.size() * sizeof(static_device::AirConditionerAdapter)) / mix.size();
+    runBench("CRTP   ", CALLS, staticBytes, [&] { benchSmartDeviceStatic(lights, acs); });
+    blackhole = lights.empty() ? 0 : lights[0].switches;
+}
+
+using StaticOrder = static_coffee::Sugar<static_coffee::Milk<static_coffee::Espresso>>;
+
+__attribute__((noinline)) double benchCoffeeVirtual(vector<unique_ptr<dynamic_coffee::Coffee>>& orders) {
+    double total = 0;
+    for (int r = 0; r < ROUNDS; r++)
+        for (auto& c : orders) total += c -> getCost();
+    return total;
+}
+
+__attribute__((noinline)) double benchCoffeeStatic(vector<StaticOrder>& orders) {
+    double total = 0;
+    for (int r = 0; r < ROUNDS; r++)
+        for (auto& c : orders) total += c.getCost();
+    return total;
+}
+
+void benchCoffee() {
+    cout << "Coffee (Sugar<Milk<Espresso>>)" << endl;
+    using namespace dynamic_coffee;
+
+    vector<unique_ptr<Coffee>> dyn;
+    for (int i = 0; i < OBJECTS; i++) {
+        dyn.push_back(make_unique<SugarDecorator>(make_unique<MilkDecorator>(make_unique<Espresso>())));
+    }
+    double total = 0;
+    // the owning pointer plus the three heap objects of the chain
+    size_t dynBytes = sizeof(unique_ptr<Coffee>) + sizeof(SugarDecorator) + sizeof(MilkDecorator) + sizeof(Espresso);
+    runBench("virtual ", CALLS, dynBytes, [&] { total += benchCoffeeVirtual(dyn); });
+
+    vector<StaticOrder> st(OBJECTS);
+    runBench("template", CALLS, sizeof(StaticOrder), [&] { total += benchCoffeeStatic(st); });
+    blackhole = (long)total;
+}
+
+__attribute__((noinline)) void benchVehicleVirtual(vector<unique_ptr<dynamic_vehicle::Vehicle>>& vehicles) {
+    for (int r = 0; r < ROUNDS; r++)
+        for (auto& v : vehicles) v -> move();
+}
+
+__attribute__((noinline)) void benchVehicleStatic(vector<static_vehicle::Vehicle>& vehicles) {
+    for (int r = 0; r < ROUNDS; r++)
+        for (auto& v : vehicles) visit([](auto& x) { x.move(); }, v);
+}
+
+void benchVehicle() {
+    cout << "Vehicle" << endl;
+    auto mix = typeMix();
+
+    vector<unique_ptr<dynamic_vehicle::Vehicle>> dyn;
+    vector<static_vehicle::Vehicle> st;
+    for (int t : mix) {
+        if (t) {
+            dyn.push_back(make_unique<dynamic_vehicle::Car>());
+            st.emplace_back(static_vehicle::Car{});
+        }
+        else {
+            dyn.push_back(make_unique<dynamic_vehicle::Bike>());
+            st.emplace_back(static_vehicle::Bike{});
+        }
+    }
+    size_t dynBytes = mixedBytes<unique_ptr<dynamic_vehicle::Vehicle>, dynamic_vehicle::Car, dynamic_vehicle::Bike>(mix);
+    runBench("virtual", CALLS, dynBytes, [&] { benchVehicleVirtual(dyn); });
+    runBench("variant", CALLS, sizeof(static_vehicle::Vehicle), [&] { benchVehicleStatic(st); });
+    blackhole = visit([](auto& x) { return x.distance; }, st[0]);
+}
+
+__attribute__((noinline)) long benchPaymentVirtual(vector<unique_ptr<dynamic_payment::PaymentStrategy>>& strategies) {
+    long charged = 0;
+    for (int r = 0; r < ROUNDS; r++)
+        for (auto& p : strategies) charged += p -> processPayment(1000 + r);
+    return charged;
+}
+
+__attribute__((noinline)) long benchPaymentStatic(vector<static_payment::PaymentStrategy>& strategies) {
+    long charged = 0;
+    for (int r = 0; r < ROUNDS; r++)
+        for (auto& p : strategies) charged += visit([&](const auto& s) { return s.processPayment(1000 + r); }, p);
+    return charged;
+}
+
+void benchPayment() {
+    cout << "PaymentStrategy" << endl;
+    auto mix = typeMix();
+
+    vector<unique_ptr<dynamic_payment::PaymentStrategy>> dyn;
+    vector<static_payment::PaymentStrategy> st;
+    for (int t : mix) {
+        if (t) {
+            dyn.push_back(make_unique<dynamic_payment::CreditCard>());
+            st.emplace_back(static_payment::CreditCard{});
+        }
+        else {
+            dyn.push_back(make_unique<dynamic_payment::DebitCard>());
+            st.emplace_back(static_payment::DebitCard{});
+        }
+    }
+    long charged = 0;
+    size_t dynBytes = mixedBytes<unique_ptr<dynamic_payment::PaymentStrategy>, dynamic_payment::CreditCard,
+                                 dynamic_payment::DebitCard>(mix);
+    runBench("virtual", CALLS, dynBytes, [&] { charged = benchPaymentVirtual(dyn); });
+    long chargedStatic = 0;
+    runBench("variant", CALLS, sizeof(static_payment::PaymentStrategy), [&] { chargedStatic = benchPaymentStatic(st); });
+    if (charged != chargedStatic) cout << "  MISMATCH: " << charged << " vs " << chargedStatic << endl;
+    blackhole = charged;
+}
+
+__attribute__((noinline)) long benchPlayerVirtual(dynamic_player::PlayerStrategy& strategy, const Board& board) {
+    long moves = 0;
+    for (long i = 0; i < CALLS; i++) moves += strategy.makeMove(board).col;
+    return moves;
+}
+
+__attribute__((noinline)) long benchPlayerStatic(static_player::Player<static_player::FirstFreeStrategy>& player,
+                                                 const Board& board) {
+    long moves = 0;
+    for (long i = 0; i < CALLS; i++) moves += player.makeMove(board).col;
+    return moves;
+}
+
+void benchPlayer() {
+    cout << "PlayerStrategy" << endl;
+    Board board;
+    memset(board.cells, ' ', sizeof(board.cells));
+    board.cells[0][0] = board.cells[0][1] = board.cells[1][1] = 'X';
+
+    long moves = 0;
+    unique_ptr<dynamic_player::PlayerStrategy> dyn = make_unique<dynamic_player::FirstFreeStrategy>();
+    size_t dynBytes = sizeof(unique_ptr<dynamic_player::PlayerStrategy>) + sizeof(dynamic_player::FirstFreeStrategy);
+    runBench("virtual", CALLS, dynBytes, [&] { moves += benchPlayerVirtual(*dyn, board); });
+
+    static_player::Player<static_player::FirstFreeStrategy> player;
+    runBench("concept", CALLS, sizeof(player), [&] { moves += benchPlayerStatic(player, board); });
+    blackhole = moves;
+}
+
+int main() {
+    cout << CALLS << " calls per variant" << endl;
+    benchSmartDevice();
+    benchCoffee();
+    benchVehicle();
+    benchPayment();
+    benchPlayer();
+    return 0;
+}